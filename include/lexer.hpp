@@ -9,10 +9,15 @@
 #include <utility>
 #include <stdexcept>
 #include <array>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include "symbol_table.hpp"
+#include "token_kind.hpp"
 
 class Token {
  public:
-  enum class Type {
+  enum class Type : std::uint8_t {
     Identifier,
     Keyword,
     CharLiteral,
@@ -22,27 +27,208 @@ class Token {
     Whitespace,
     Comment,
   };
-  constexpr static std::array<Type, 8> types = {
-    Type::Identifier, Type::Keyword, Type::CharLiteral, Type::StringLiteral,
-    Type::IntegerLiteral, Type::Punctuation, Type::Whitespace, Type::Comment
-  };
   Token();
   Token(Type t);
-  Token(Type t, const std::string &v);
-  void read_from(const std::string_view &);
+  Token(Type t, std::string_view v);
+  explicit Token(TokenKind k); // spelled keyword or punctuation, or an unspelled token of another kind
   bool match(const Token&) const;
 
   Type type;
-  std::string value;
+  TokenKind kind; // one per keyword and punctuation, so these are compared without their spelling
+  std::uint32_t offset; // byte offset in the lexed input, fits in the padding before value
+  std::string_view value; // points into the lexed input, which must outlive the token
 };
 
+constexpr Token::Type token_type(TokenKind kind) {
+  if (is_keyword(kind)) {
+    return Token::Type::Keyword;
+  }
+  if (is_punctuation(kind)) {
+    return Token::Type::Punctuation;
+  }
+  switch (kind) {
+    case TokenKind::Identifier: return Token::Type::Identifier;
+    case TokenKind::CharLiteral: return Token::Type::CharLiteral;
+    case TokenKind::StringLiteral: return Token::Type::StringLiteral;
+    case TokenKind::IntegerLiteral: return Token::Type::IntegerLiteral;
+    case TokenKind::Whitespace: return Token::Type::Whitespace;
+    default: return Token::Type::Comment;
+  }
+}
+
+// the fixed spelling of a keyword or punctuation, empty for other kinds
+std::string_view token_spelling(TokenKind kind);
+
+static_assert(sizeof(Token) == sizeof(std::string_view) + 8, "Token should stay three words");
+
 /* generated by copilot */
 class LexerError : public std::runtime_error {
  public:
   explicit LexerError(const std::string &message) : std::runtime_error(message) {}
+  LexerError(const std::string &message, std::size_t position) : std::runtime_error(message), position{position} {}
+
+  std::size_t position = 0; // byte offset of the failing token in the lexed input
+};
+
+/* pulls tokens from input one at a time, skipping whitespace and comments */
+class Lexer {
+ public:
+  class iterator;
+
+  explicit Lexer(std::string_view input);
+  std::optional<Token> next();
+  std::string_view source() const { return input; }
+  iterator begin();
+  std::default_sentinel_t end() const;
+
+ private:
+  std::string_view input;
+  size_t position;
+};
+
+class Lexer::iterator {
+ public:
+  using value_type = Token;
+  using difference_type = std::ptrdiff_t;
+
+  iterator() = default;
+  explicit iterator(Lexer &lexer);
+  const Token &operator*() const;
+  const Token *operator->() const;
+  iterator &operator++();
+  void operator++(int);
+  bool operator==(std::default_sentinel_t) const;
+
+ private:
+  Lexer *lexer = nullptr;
+  std::optional<Token> current;
+};
+
+/* a literal decoded once by the lexer: integers keep their value and type suffix, char and string
+   literals their unescaped bytes as an id into the literal pool */
+struct Literal {
+  enum class Suffix : std::uint8_t { None, I8, I16, I32, I64, I128, Isize, U8, U16, U32, U64, U128, Usize };
+
+  std::uint64_t integer = 0;
+  std::uint64_t integer_high = 0; // bits 64 to 127, only nonzero for i128 and u128 literals
+  Suffix suffix = Suffix::None;
+  SymbolId string = SymbolTable::none;
+};
+
+/* lexed tokens stored as parallel arrays, so a pass over one field only touches that field;
+   tokens are rebuilt on access and their values point into the source. Identifiers and
+   literals are interned as they are added, so equal spellings share one symbol id; literals are
+   decoded when their spelling is first seen, and a malformed one throws LexerError. Whitespace and
+   comments are only kept on request, as start offsets grouped by the token that follows them */
+class TokenBuffer {
+ public:
+  class iterator;
+
+  TokenBuffer() = default;
+  explicit TokenBuffer(std::string_view source);
+  void push_back(const Token &token);
+  void push_trivia(std::uint32_t offset); // whitespace or a comment before the next token pushed
+  void append(const TokenBuffer &other, std::size_t first); // other's tokens from first on, same source
+  // switches to an edited source, replaces tokens [first, last) with replacement's and moves the
+  // offsets of later tokens by shift
+  void splice(std::string_view edited, std::size_t first, std::size_t last, const TokenBuffer &replacement,
+              std::ptrdiff_t shift);
+  // drops the tokens along with the spellings and literals interned for them, so a buffer that is
+  // cleared between tokens stays the size of one token
+  void clear();
+  void reserve(std::size_t count);
+  std::size_t size() const { return kinds.size(); }
+  bool empty() const { return kinds.empty(); }
+  Token operator[](std::size_t index) const;
+  bool matches(std::size_t index, const Token &pattern) const; // pattern.match((*this)[index])
+  iterator begin() const;
+  iterator end() const;
+
+  TokenKind kind(std::size_t index) const { return kinds[index]; }
+  Token::Type type(std::size_t index) const { return token_type(kinds[index]); }
+  std::uint32_t offset(std::size_t index) const { return offsets[index]; }
+  std::uint32_t length(std::size_t index) const { return lengths[index]; }
+  std::string_view value(std::size_t index) const { return source.substr(offsets[index], lengths[index]); }
+  // SymbolTable::none for keywords and punctuation, which are told apart by kind
+  SymbolId symbol(std::size_t index) const { return symbol_ids[index]; }
+  const SymbolTable &symbols() const { return symbol_table; }
+  // decoded value of an integer, char or string literal token
+  const Literal &literal(std::size_t index) const { return literals[symbol_ids[index]]; }
+  // unescaped char and string literals, each distinct value stored once
+  const SymbolTable &literal_pool() const { return pool; }
+  // whitespace and comments before token index, or after the last token if index is size()
+  std::size_t trivia_count(std::size_t index) const { return first_trivia(index + 1) - first_trivia(index); }
+  Token trivia(std::size_t index, std::size_t piece) const;
+
+ private:
+  SymbolId intern(std::string_view spelling, TokenKind kind, std::uint32_t offset);
+  std::size_t first_trivia(std::size_t index) const {
+    return index < trivia_first.size() ? trivia_first[index] : trivia_offsets.size();
+  }
+
+  std::string_view source;
+  std::vector<TokenKind> kinds;
+  std::vector<std::uint32_t> offsets;
+  std::vector<std::uint32_t> lengths;
+  std::vector<SymbolId> symbol_ids;
+  SymbolTable symbol_table;
+  std::vector<Literal> literals; // indexed by symbol id
+  SymbolTable pool;
+  std::vector<std::uint32_t> trivia_offsets;
+  // first trivia piece before each token; filled as pieces are pushed, so tokens after the last
+  // piece have no entry and pushing tokens costs nothing extra
+  std::vector<std::uint32_t> trivia_first;
+};
+
+class TokenBuffer::iterator {
+ public:
+  using value_type = Token;
+  using difference_type = std::ptrdiff_t;
+
+  iterator() = default;
+  iterator(const TokenBuffer &buffer, std::size_t index) : buffer{&buffer}, index{index} {}
+  Token operator*() const { return (*buffer)[index]; }
+  iterator &operator++() { ++index; return *this; }
+  iterator operator++(int) { iterator old = *this; ++index; return old; }
+  bool operator==(const iterator &other) const { return index == other.index; }
+
+ private:
+  const TokenBuffer *buffer = nullptr;
+  std::size_t index = 0;
 };
 
 std::pair<char, int> read_characters(const std::string_view &);
-std::vector<Token> lex(const std::string_view &);
+// with keep_trivia, whitespace and comments are recorded too (see TokenBuffer::trivia)
+TokenBuffer lex(const std::string_view &, bool keep_trivia = false);
+// same tokens, symbol ids and errors as lex(), but chunks of about chunk_size bytes are lexed
+// speculatively on up to threads threads (0 for one per core) and their seams repaired afterwards;
+// inputs smaller than two chunks are lexed on the calling thread
+TokenBuffer lex_parallel(const std::string_view &, unsigned threads = 0, std::size_t chunk_size = 1 << 20);
+
+/* removed bytes at offset replaced by inserted */
+struct SourceEdit {
+  std::size_t offset = 0;
+  std::size_t removed = 0;
+  std::string_view inserted;
+};
+
+/* tokens [first, old_end) of a buffer were replaced by tokens [first, new_end); tokens after them
+   are the old ones, moved by the length change of the edit */
+struct TokenChange {
+  std::size_t first = 0;
+  std::size_t old_end = 0;
+  std::size_t new_end = 0;
+};
+
+struct Relexed {
+  TokenBuffer tokens;
+  TokenChange changed;
+};
+
+// the tokens of source, which must be the source previous was lexed from with edit applied; only the
+// tokens from just before the edit up to where the token stream rejoins the old one are relexed.
+// Tokens and errors are the same as lex(source); symbol ids of kept tokens do not change and trivia
+// is not kept
+Relexed relex(TokenBuffer previous, std::string_view source, const SourceEdit &edit);
 
 #endif
\ No newline at end of file
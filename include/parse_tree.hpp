@@ -6,6 +6,7 @@
 #include <iostream>
 #include <memory>
 #include <vector>
+#include "lexer.hpp"
 
 // visitor pattern - forward declarations
 class TreeVisitor;
@@ -379,18 +380,23 @@ class CharLiteralNode : public TreeNode {
 public:
    std::any accept(TreeVisitor& visitor) override;
    std::string value;
+   std::string decoded; // value with the quotes removed and escapes applied
 };
 
 class StringLiteralNode : public TreeNode {
 public:
    std::any accept(TreeVisitor& visitor) override;
    std::string value;
+   std::string decoded; // value with the quotes removed and escapes applied
 };
 
 class IntegerLiteralNode : public TreeNode {
 public:
    std::any accept(TreeVisitor& visitor) override;
    std::string value;
+   std::uint64_t integer = 0;
+   std::uint64_t integer_high = 0;
+   Literal::Suffix suffix = Literal::Suffix::None;
 };
 
 class PunctuationNode : public TreeNode {
@@ -3,27 +3,109 @@
 #ifndef _PARSER_HPP_
 #define _PARSER_HPP_
 
+#include <array>
+#include <bitset>
+#include <cstdint>
 #include <memory>
 #include <vector>
+#include <map>
 #include <set>
+#include <unordered_map>
 #include <optional>
+#include <utility>
 #include "lexer.hpp"
 #include "parse_rules.hpp"
 
 // Forward declarations for parse tree nodes
 class TreeNode;
 
+/* an Earley item: a dotted rule, numbered by the grammar tables compiled from parse_rules, and
+   the chart its production was predicted in */
 class ParsingState {
  public:
-  int nonterminal_type;
-  std::size_t production_index;
-  std::size_t position_in_production;
+  std::uint32_t dotted_rule;
   std::size_t start_token_index;
+
+  // the item for nonterminal's production with the dot before symbol position
+  static ParsingState at(Nonterminal nonterminal, std::size_t production, std::size_t position, std::size_t start);
+  int nonterminal_type() const;
+  std::size_t production_index() const;
+  std::size_t position_in_production() const;
   bool operator == (const ParsingState &) const;
   bool operator < (const ParsingState &) const;
 };
 
+/* the items added to one chart, in an open-addressing table of packed items, so adding an item
+   does not search the chart */
+class ItemSet {
+ public:
+  bool insert(const ParsingState &); // false if the item is already in the set
+  void clear();
+
+ private:
+  std::vector<std::uint64_t> slots; // packed item + 1, 0 for an empty slot
+  std::size_t count = 0;
+
+  void grow();
+};
+
+
+/* the items of a finished chart whose dot is before a nonterminal, grouped by that nonterminal in
+   chart order, with the dot already moved past it; the completer only reads the items it advances */
+struct WaitingItems {
+  std::array<std::uint32_t, 98> begin; // items waiting for nonterminal n are [begin[n], begin[n + 1])
+  std::vector<ParsingState> items;
+  // Leo's deterministic reductions: nonterminals with a single waiting item that is completed by
+  // completing them, sorted, each with the topmost completed item of the chain of such items
+  std::vector<std::pair<std::uint8_t, ParsingState>> leo;
+};
+
+/* completed items by nonterminal and origin, for finding the children of a node while building the
+   CST; completed items that deterministic reductions kept out of the charts are rebuilt from the
+   waiting items only for the lookups that need them */
+class CompletedItems {
+ public:
+  using Found = std::optional<std::pair<ParsingState, std::size_t>>; // an item and its chart
 
+  CompletedItems(const std::vector<std::vector<ParsingState>> &table, const std::vector<WaitingItems> &waiting);
+  // the first item of the latest chart up to last that completes nonterminal from origin
+  Found latest(Nonterminal nonterminal, std::size_t origin, std::size_t last) const;
+  // the first item of chart that completes nonterminal from origin
+  std::optional<ParsingState> in_chart(Nonterminal nonterminal, std::size_t origin, std::size_t chart) const;
+
+ private:
+  // the waiting item of a deterministic reduction: completed wherever nonterminal is completed from origin
+  struct Reduction {
+    std::uint8_t nonterminal;
+    std::size_t origin;
+    ParsingState reduced;
+  };
+
+  struct Completed {
+    std::uint8_t nonterminal;
+    std::size_t chart;
+    ParsingState state;
+  };
+
+  static std::uint64_t key(std::size_t nonterminal, std::size_t origin) { return origin << 7 | nonterminal; }
+  Found in_table(std::uint64_t key, std::size_t last) const;
+
+  std::vector<Completed> items; // the completed items of the charts by origin, nonterminal and chart
+  std::vector<std::uint32_t> origin_begin; // items from origin o are [origin_begin[o], origin_begin[o + 1])
+  std::unordered_map<std::uint64_t, std::vector<Reduction>> reductions; // by the reduced item's key
+  mutable std::map<std::pair<std::uint64_t, std::size_t>, Found> lookups; // latest() of keys with reductions
+};
+
+/* one bit per distinct terminal pattern of parse_rules; a token's mask holds the patterns it matches */
+using TerminalMask = std::bitset<128>;
+
+/* one bit per nonterminal */
+using NonterminalSet = std::bitset<97>;
+
+// whether nonterminal derives the empty string in parse_rules
+bool is_nullable(Nonterminal nonterminal);
+// the nonterminals the predictor adds along with nonterminal, nonterminal included
+NonterminalSet prediction_closure(Nonterminal nonterminal);
 
 // generated by copilot
 class ParseError : public std::runtime_error {
@@ -33,7 +115,9 @@ class ParseError : public std::runtime_error {
 
 class EarleyParser {
  public:
-  EarleyParser(std::vector<Token> &&);
+  EarleyParser(TokenBuffer &&);
+  // pulls tokens from the lexer while building the charts; parse() needs keep_tokens
+  EarleyParser(Lexer &, bool keep_tokens = true);
   EarleyParser(const EarleyParser &) = delete;
   EarleyParser(EarleyParser &&) = delete;
   EarleyParser& operator=(const EarleyParser &) = delete;
@@ -41,20 +125,34 @@ class EarleyParser {
   ~EarleyParser() = default;
   bool accepts() const;
   std::unique_ptr<TreeNode> parse() const;
+  std::size_t item_count() const; // items in all charts
+  CompletedItems completed_items() const;
 
  private:
-  const std::vector<Token> tokens;
+  static constexpr std::size_t no_token = static_cast<std::size_t>(-1);
+
+  TokenBuffer tokens;
+  bool tokens_kept;
   std::vector<std::vector<ParsingState>> table;
+  // items are only ever added to the chart being processed and the next one, so two sets suffice
+  std::array<ItemSet, 2> chart_items;
+  // chart positions of the items waiting for each nonterminal, kept as items are added to those two
+  // charts and compacted into waiting once a chart is finished
+  std::array<std::array<std::vector<std::uint32_t>, 97>, 2> chart_waiting;
+  std::vector<WaitingItems> waiting;
+  // nonterminals predicted in the chart being processed
+  NonterminalSet predicted;
 
   bool is_finished(const ParsingState& state) const;
-  bool is_empty_production(const ParsingState& state) const;
-  Symbol next_element(const ParsingState& state) const;
-  bool is_nonterminal(const Symbol& symbol) const;
-  bool is_terminal(const Symbol& symbol) const;
   void add_to_set(ParsingState state, std::size_t chart_index);
   void predictor(const ParsingState& state, std::size_t chart_index);
-  void scanner(const ParsingState& state, std::size_t chart_index);
+  void scanner(const ParsingState& state, std::size_t chart_index, const TerminalMask& token_mask);
   void completer(const ParsingState& state, std::size_t chart_index);
+  void start();
+  void open_chart();
+  void finish_chart(std::size_t chart_index);
+  const ParsingState* leo_top(std::size_t chart_index, std::uint8_t nonterminal) const;
+  void process_chart(std::size_t chart_index, std::size_t token_index);
   bool parse_state(const ParsingState& state, std::size_t i, std::size_t j) const;
 };
 
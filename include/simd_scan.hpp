@@ -0,0 +1,25 @@
+#pragma once
+
+#ifndef _SIMD_SCAN_HPP_
+#define _SIMD_SCAN_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* byte-scanning kernels for the lexer; the widest instruction set the CPU supports
+   (AVX2, SSE2 or plain scalar code) is picked at the first call */
+
+// first byte in [begin, end) that is not ASCII whitespace, or end
+const char *skip_whitespace(const char *begin, const char *end);
+
+// first '/' or '*' in [begin, end), or end
+const char *find_comment_delimiter(const char *begin, const char *end);
+
+// appends the offset from begin of the byte after each '\n' in [begin, end)
+void find_line_starts(const char *begin, const char *end, std::vector<std::uint32_t> &starts);
+
+// start of the first malformed UTF-8 sequence in [begin, end), or end if the input is valid
+const char *validate_utf8(const char *begin, const char *end);
+
+#endif
@@ -0,0 +1,59 @@
+#pragma once
+
+#ifndef _SOURCE_HPP_
+#define _SOURCE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/* 1-based line and byte column */
+struct SourceLocation {
+  std::uint32_t line;
+  std::uint32_t column;
+};
+
+/* the bytes of one input; tokens lexed from text() point into it */
+class SourceBuffer {
+ public:
+  SourceBuffer(std::string name, std::string content);
+  // maps the regular file open on fd read-only; fd may be closed afterwards
+  SourceBuffer(std::string name, int fd, std::size_t size);
+  SourceBuffer(const SourceBuffer &) = delete;
+  SourceBuffer& operator=(const SourceBuffer &) = delete;
+  ~SourceBuffer();
+
+  const std::string &name() const;
+  std::string_view text() const;
+  // builds the line table on first use, so inputs without diagnostics never pay for it
+  SourceLocation location(std::uint32_t offset) const;
+
+ private:
+  std::string buffer_name;
+  std::string content; // owned bytes when the input is not mapped
+  void *mapping = nullptr;
+  std::size_t mapping_size = 0;
+  std::string_view bytes;
+  mutable std::once_flag line_table_built;
+  mutable std::vector<std::uint32_t> line_starts;
+};
+
+/* owns every SourceBuffer, so token views stay valid as long as the manager lives */
+class SourceManager {
+ public:
+  const SourceBuffer &add(std::string name, std::string content);
+  // regular files are memory-mapped, anything else is read in one go; throws std::system_error
+  const SourceBuffer &add_file(const std::string &path);
+  const SourceBuffer &add_stdin();
+
+ private:
+  std::vector<std::unique_ptr<SourceBuffer>> buffers;
+
+  const SourceBuffer &add_descriptor(std::string name, int fd);
+};
+
+#endif
@@ -0,0 +1,46 @@
+#pragma once
+
+#ifndef _SYMBOL_TABLE_HPP_
+#define _SYMBOL_TABLE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+using SymbolId = std::uint32_t;
+
+/* interns spellings into dense ids, so equal identifiers and literals compare as integers;
+   each unique spelling is copied once into an arena and stays valid for the table's lifetime */
+class SymbolTable {
+ public:
+  static constexpr SymbolId none = static_cast<SymbolId>(-1);
+
+  SymbolTable() = default;
+  SymbolTable(const SymbolTable &) = delete;
+  SymbolTable& operator=(const SymbolTable &) = delete;
+  SymbolTable(SymbolTable &&) = default;
+  SymbolTable& operator=(SymbolTable &&) = default;
+
+  SymbolId intern(std::string_view spelling);
+  std::optional<SymbolId> find(std::string_view spelling) const;
+  std::string_view spelling(SymbolId id) const { return spellings[id]; }
+  std::size_t size() const { return spellings.size(); }
+  // forgets every spelling, so ids start over; the current arena block and the slots are reused
+  void clear();
+
+ private:
+  std::string_view store(std::string_view spelling);
+  void grow();
+
+  std::vector<std::unique_ptr<char[]>> blocks;
+  std::size_t block_used = 0;
+  std::size_t block_size = 0;
+  std::vector<std::string_view> spellings; // indexed by id
+  std::vector<std::size_t> hashes;         // indexed by id, reused when the slots grow
+  std::vector<SymbolId> slots;             // open addressing, id + 1 or 0 when empty
+};
+
+#endif
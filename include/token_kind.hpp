@@ -0,0 +1,135 @@
+#pragma once
+
+#ifndef _TOKEN_KIND_HPP_
+#define _TOKEN_KIND_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+/* keywords as X(kind, spelling); the lexer's keyword table is built from this list */
+#define KEYWORD_TOKEN_KINDS(X) \
+  X(KwAs, "as") \
+  X(KwBreak, "break") \
+  X(KwConst, "const") \
+  X(KwContinue, "continue") \
+  X(KwCrate, "crate") \
+  X(KwElse, "else") \
+  X(KwEnum, "enum") \
+  X(KwFalse, "false") \
+  X(KwFn, "fn") \
+  X(KwFor, "for") \
+  X(KwIf, "if") \
+  X(KwImpl, "impl") \
+  X(KwIn, "in") \
+  X(KwLet, "let") \
+  X(KwLoop, "loop") \
+  X(KwMatch, "match") \
+  X(KwMod, "mod") \
+  X(KwMove, "move") \
+  X(KwMut, "mut") \
+  X(KwPub, "pub") \
+  X(KwRef, "ref") \
+  X(KwReturn, "return") \
+  X(KwSelfValue, "self") \
+  X(KwSelfType, "Self") \
+  X(KwStatic, "static") \
+  X(KwStruct, "struct") \
+  X(KwSuper, "super") \
+  X(KwTrait, "trait") \
+  X(KwTrue, "true") \
+  X(KwType, "type") \
+  X(KwUnsafe, "unsafe") \
+  X(KwUse, "use") \
+  X(KwWhere, "where") \
+  X(KwWhile, "while") \
+  X(KwDyn, "dyn")
+
+/* punctuation as X(kind, spelling); the lexer's punctuation trie is built from this list */
+#define PUNCTUATION_TOKEN_KINDS(X) \
+  X(ShlEq, "<<=") \
+  X(ShrEq, ">>=") \
+  X(DotDotEq, "..=") \
+  X(DotDotDot, "...") \
+  X(Le, "<=") \
+  X(Ge, ">=") \
+  X(EqEq, "==") \
+  X(Ne, "!=") \
+  X(AndAnd, "&&") \
+  X(OrOr, "||") \
+  X(Shl, "<<") \
+  X(Shr, ">>") \
+  X(PlusEq, "+=") \
+  X(MinusEq, "-=") \
+  X(StarEq, "*=") \
+  X(SlashEq, "/=") \
+  X(PercentEq, "%=") \
+  X(CaretEq, "^=") \
+  X(AndEq, "&=") \
+  X(OrEq, "|=") \
+  X(DotDot, "..") \
+  X(PathSep, "::") \
+  X(RArrow, "->") \
+  X(LArrow, "<-") \
+  X(FatArrow, "=>") \
+  X(Eq, "=") \
+  X(Lt, "<") \
+  X(Gt, ">") \
+  X(Not, "!") \
+  X(Tilde, "~") \
+  X(Plus, "+") \
+  X(Minus, "-") \
+  X(Star, "*") \
+  X(Slash, "/") \
+  X(Percent, "%") \
+  X(Caret, "^") \
+  X(And, "&") \
+  X(Or, "|") \
+  X(At, "@") \
+  X(Dot, ".") \
+  X(Comma, ",") \
+  X(Semi, ";") \
+  X(Colon, ":") \
+  X(Pound, "#") \
+  X(Dollar, "$") \
+  X(Question, "?") \
+  X(Underscore, "_") \
+  X(LBrace, "{") \
+  X(RBrace, "}") \
+  X(LBracket, "[") \
+  X(RBracket, "]") \
+  X(LParen, "(") \
+  X(RParen, ")")
+
+/* one kind per keyword and punctuation, so the parser tells terminals apart by kind alone */
+enum class TokenKind : std::uint8_t {
+  Identifier,
+  CharLiteral,
+  StringLiteral,
+  IntegerLiteral,
+  Whitespace,
+  Comment,
+#define TOKEN_KIND(kind, spelling) kind,
+  KEYWORD_TOKEN_KINDS(TOKEN_KIND)
+  PUNCTUATION_TOKEN_KINDS(TOKEN_KIND)
+#undef TOKEN_KIND
+};
+
+#define TOKEN_KIND_COUNT(kind, spelling) + 1
+constexpr std::size_t keyword_kind_count = 0 KEYWORD_TOKEN_KINDS(TOKEN_KIND_COUNT);
+constexpr std::size_t punctuation_kind_count = 0 PUNCTUATION_TOKEN_KINDS(TOKEN_KIND_COUNT);
+#undef TOKEN_KIND_COUNT
+
+constexpr std::size_t first_keyword_kind = static_cast<std::size_t>(TokenKind::Comment) + 1;
+constexpr std::size_t first_punctuation_kind = first_keyword_kind + keyword_kind_count;
+constexpr std::size_t token_kind_count = first_punctuation_kind + punctuation_kind_count;
+
+constexpr bool is_keyword(TokenKind kind) {
+  auto k = static_cast<std::size_t>(kind);
+  return k >= first_keyword_kind && k < first_punctuation_kind;
+}
+
+constexpr bool is_punctuation(TokenKind kind) {
+  return static_cast<std::size_t>(kind) >= first_punctuation_kind;
+}
+
+#endif
@@ -1,29 +1,137 @@
 #include "lexer.hpp"
+#include "simd_scan.hpp"
 #include <stdexcept>
-#include <cctype>
-#include <set>
+#include <cstdint>
 #include <array>
+#include <algorithm>
+#include <limits>
+#include <atomic>
+#include <cstring>
+#include <thread>
 
-/* cannot be constexpr */
-const std::set<std::string> keywords{
-  "as", "break", "const", "continue", "crate", "else", "enum", "false", "fn", "for", "if", "impl", "in", "let",
-  "loop", "match", "mod", "move", "mut", "pub", "ref", "return", "self", "Self", "static", "struct", "super",
-  "trait", "true", "type", "unsafe", "use", "where", "while", "dyn"
+#define TOKEN_SPELLING(kind, spelling) spelling,
+
+/* indexed by TokenKind */
+constexpr std::array<std::string_view, token_kind_count> token_spellings{
+  "", "", "", "", "", "",
+  KEYWORD_TOKEN_KINDS(TOKEN_SPELLING)
+  PUNCTUATION_TOKEN_KINDS(TOKEN_SPELLING)
+};
+
+constexpr std::array<std::string_view, keyword_kind_count> keywords{
+  KEYWORD_TOKEN_KINDS(TOKEN_SPELLING)
+};
+
+constexpr std::array<std::string_view, punctuation_kind_count> punctuations{
+  PUNCTUATION_TOKEN_KINDS(TOKEN_SPELLING)
 };
 
-constexpr std::array<const char*, 53> punctuations{
-  "<<=", ">>=", "..=", "...",
-  "<=", ">=", "==", "!=", 
-  "&&", "||", 
-  "<<", ">>",
-  "+=", "-=", "*=", "/=", "%=", "^=", "&=", "|=",
-  "..", "::", "->", "<-", "=>",
-  "=", "<", ">", 
-  "!", "~", "+", "-", "*", "/", "%", "^", "&", "|",
-  "@", ".", ",", ";", ":", "#", "$", "?", "_",
-  "{", "}", "[", "]", "(", ")",
+#undef TOKEN_SPELLING
+
+static_assert(token_spellings[first_keyword_kind] == keywords.front() &&
+              token_spellings[first_punctuation_kind] == punctuations.front());
+
+constexpr TokenKind keyword_kind(int keyword) {
+  return static_cast<TokenKind>(first_keyword_kind + keyword);
+}
+
+constexpr TokenKind punctuation_kind(int punct) {
+  return static_cast<TokenKind>(first_punctuation_kind + punct);
+}
+
+std::string_view token_spelling(TokenKind kind) {
+  return token_spellings[static_cast<size_t>(kind)];
+}
+
+/* keywords are 2 to 8 bytes long, so a candidate word fits in one 64-bit key */
+constexpr std::uint64_t keyword_key(std::string_view word) {
+  std::uint64_t key = 0;
+  for (size_t i = 0; i < word.size(); ++i) {
+    key |= static_cast<std::uint64_t>(static_cast<unsigned char>(word[i])) << (8 * i);
+  }
+  return key;
+}
+
+/* multiplier found by an offline search; the top 6 bits of key * multiplier differ for every keyword */
+constexpr std::uint64_t keyword_hash_multiplier = 0xced9719e67b1db85;
+
+constexpr size_t keyword_slot(std::string_view word) {
+  return (keyword_key(word) * keyword_hash_multiplier) >> 58;
+}
+
+constexpr std::array<std::int8_t, 64> keyword_slots = [] {
+  std::array<std::int8_t, 64> slots{};
+  slots.fill(-1);
+  for (size_t i = 0; i < keywords.size(); ++i) {
+    slots[keyword_slot(keywords[i])] = static_cast<std::int8_t>(i);
+  }
+  return slots;
+}();
+
+static_assert([] {
+  for (size_t i = 0; i < keywords.size(); ++i) {
+    if (keyword_slots[keyword_slot(keywords[i])] != static_cast<std::int8_t>(i)) {
+      return false;
+    }
+  }
+  return true;
+}(), "keyword hash must be perfect");
+
+/* index into keywords, or -1 if word is not a keyword */
+static
+int keyword_id(std::string_view word) {
+  if (word.size() < 2 || word.size() > 8) {
+    return -1;
+  }
+  int id = keyword_slots[keyword_slot(word)];
+  return id >= 0 && keywords[id] == word ? id : -1;
+}
+
+/* trie over punctuations, generated at compile time; node 0 is the root */
+struct PunctuationTrie {
+  std::array<std::uint8_t, 256> char_class{}; // 0 for bytes that appear in no punctuation
+  std::array<std::array<std::uint8_t, 32>, 64> next{}; // 0 for no transition, the root is never a target
+  std::array<std::int8_t, 64> accept{}; // index into punctuations, -1 if no punctuation ends here
 };
 
+constexpr PunctuationTrie punctuation_trie = [] {
+  PunctuationTrie trie;
+  trie.accept.fill(-1);
+  std::uint8_t classes = 0, nodes = 1;
+  for (size_t i = 0; i < punctuations.size(); ++i) {
+    size_t node = 0;
+    for (char c: punctuations[i]) {
+      auto &cls = trie.char_class[static_cast<unsigned char>(c)];
+      if (cls == 0) {
+        cls = ++classes;
+      }
+      if (trie.next[node][cls] == 0) {
+        trie.next[node][cls] = nodes++;
+      }
+      node = trie.next[node][cls];
+    }
+    trie.accept[node] = static_cast<std::int8_t>(i);
+  }
+  return trie;
+}();
+
+/* longest punctuation at the beginning of input as (index into punctuations, length), index -1 if none */
+static
+std::pair<int, size_t> match_punctuation(std::string_view input) {
+  std::pair<int, size_t> longest{-1, 0};
+  size_t node = 0;
+  for (size_t i = 0; i < input.size(); ++i) {
+    node = punctuation_trie.next[node][punctuation_trie.char_class[static_cast<unsigned char>(input[i])]];
+    if (node == 0) {
+      break;
+    }
+    if (punctuation_trie.accept[node] >= 0) {
+      longest = {punctuation_trie.accept[node], i + 1};
+    }
+  }
+  return longest;
+}
+
 /* generated by copilot */
 std::pair<char, int> read_characters(const std::string_view &input) {
   if (input.empty()) {
@@ -58,151 +166,801 @@ std::pair<char, int> read_characters(const std::string_view &input) {
 }
 
 Token::Token() = default;
-Token::Token(Type t) : type{t}, value{} {}
-Token::Token(Type t, const std::string &v) : type{t}, value{v} {}
+Token::Token(Type t) : Token(t, {}) {}
+// keywords and punctuation need their spelling to pick a kind
+Token::Token(Type t, std::string_view v) : type{t}, kind{}, offset{0}, value{v} {
+  switch (t) {
+    case Type::Identifier: kind = TokenKind::Identifier; break;
+    case Type::CharLiteral: kind = TokenKind::CharLiteral; break;
+    case Type::StringLiteral: kind = TokenKind::StringLiteral; break;
+    case Type::IntegerLiteral: kind = TokenKind::IntegerLiteral; break;
+    case Type::Whitespace: kind = TokenKind::Whitespace; break;
+    case Type::Comment: kind = TokenKind::Comment; break;
+    case Type::Keyword: {
+      int keyword = keyword_id(v);
+      if (keyword < 0) {
+        throw std::runtime_error("Not a keyword: " + std::string(v));
+      }
+      kind = keyword_kind(keyword);
+      break;
+    }
+    case Type::Punctuation: {
+      auto [punct, len] = match_punctuation(v);
+      if (punct < 0 || len != v.size()) {
+        throw std::runtime_error("Not a punctuation: " + std::string(v));
+      }
+      kind = punctuation_kind(punct);
+      break;
+    }
+  }
+}
+Token::Token(TokenKind k) : type{token_type(k)}, kind{k}, offset{0}, value{token_spelling(k)} {}
 
 bool Token::match(const Token& other) const {
-  return this->type == other.type && (this->value == "" || this->value == other.value);
+  if (this->kind != other.kind) {
+    return false;
+  }
+  // the kind fully identifies keywords and punctuation; other tokens match any spelling unless one is given
+  return this->value.empty() || is_keyword(this->kind) || is_punctuation(this->kind) || this->value == other.value;
 }
 
-void Token::read_from(const std::string_view &input) {
-  if (!value.empty()) {
-    throw std::runtime_error("Token value already set"); // error message is generated by copilot
+namespace {
+
+/* start state of the lexer DFA, chosen by the first byte of a token */
+enum class LexState : unsigned char {
+  Fail,
+  Word,
+  Integer,
+  Char,
+  String,
+  Whitespace,
+  Slash,
+  Punctuation,
+};
+
+/* byte classes used by the scanning loops instead of <cctype>, so lexing does not depend on the
+   process locale; bytes >= 0x80 belong to no class and can only appear inside literals and comments */
+enum CharClass : std::uint8_t {
+  IdentStart = 1 << 0,
+  IdentContinue = 1 << 1,
+  Digit = 1 << 2,
+  Space = 1 << 3,
+  PunctStart = 1 << 4,
+};
+
+constexpr std::array<std::uint8_t, 256> char_classes = [] {
+  std::array<std::uint8_t, 256> table{};
+  for (int c = 0; c < 256; ++c) {
+    if (punctuation_trie.char_class[c] != 0 && punctuation_trie.next[0][punctuation_trie.char_class[c]] != 0) {
+      table[c] |= PunctStart;
+    }
   }
-  if (input.empty()) {
-    throw std::runtime_error("Input is empty"); // error message is generated by copilot
+  for (int c = 'a'; c <= 'z'; ++c) {
+    table[c] |= IdentStart | IdentContinue;
   }
-  switch (type) {
-    case Type::Identifier:
-    case Type::Keyword: {
-      if (!std::isalpha(input[0])) {
-        break;
-      }
-      for (char c: input) {
-        if (std::isalnum(c) || c == '_') {
-          value.push_back(c);
-        } else {
-          break;
-        }
-      }
-      if (static_cast<bool>(keywords.count(value)) ^ (type == Type::Keyword)) {
-        value.clear();
-        break;
-      }
-      break;
+  for (int c = 'A'; c <= 'Z'; ++c) {
+    table[c] |= IdentStart | IdentContinue;
+  }
+  for (int c = '0'; c <= '9'; ++c) {
+    table[c] |= Digit | IdentContinue;
+  }
+  table['_'] |= IdentContinue; // a lone '_' is punctuation, so it does not start a word
+  for (char c: {' ', '\t', '\n', '\v', '\f', '\r'}) {
+    table[static_cast<unsigned char>(c)] |= Space;
+  }
+  return table;
+}();
+
+constexpr bool has_class(char c, std::uint8_t classes) {
+  return (char_classes[static_cast<unsigned char>(c)] & classes) != 0;
+}
+
+/* generated at compile time from the token rules above */
+constexpr std::array<LexState, 256> start_states = [] {
+  std::array<LexState, 256> table{};
+  for (int c = 0; c < 256; ++c) {
+    char byte = static_cast<char>(c);
+    if (has_class(byte, PunctStart)) {
+      table[c] = LexState::Punctuation;
     }
-    case Type::CharLiteral:
-    case Type::StringLiteral: {
-      if ((type == Type::CharLiteral && input[0] != '\'') ||
-          (type == Type::StringLiteral && input[0] != '"')) {
-        break;
+    if (has_class(byte, IdentStart)) {
+      table[c] = LexState::Word;
+    }
+    if (has_class(byte, Digit)) {
+      table[c] = LexState::Integer;
+    }
+    if (has_class(byte, Space)) {
+      table[c] = LexState::Whitespace;
+    }
+  }
+  table['\''] = LexState::Char;
+  table['"'] = LexState::String;
+  table['/'] = LexState::Slash;
+  return table;
+}();
+
+size_t scan_word(const std::string_view &input) {
+  size_t i = 1;
+  while (i < input.size() && has_class(input[i], IdentContinue)) {
+    ++i;
+  }
+  return i;
+}
+
+/* returns 0 if the literal is unterminated or has an invalid escape */
+size_t scan_quoted(const std::string_view &input) {
+  const char quote = input[0];
+  size_t i = 1;
+  try {
+    while (i < input.size()) {
+      // the input is valid UTF-8, so only the quote and '\\' need a closer look; every other byte,
+      // including all bytes of multi-byte characters, is skipped as part of one run
+      while (i < input.size() && input[i] != quote && input[i] != '\\') {
+        ++i;
       }
-      size_t i = 1;
-      try {
-        while (i < input.size()) {
-          auto [c, len] = read_characters(input.substr(i));
-          if (c == input[0] && len == 1) {
-            break;
-          }
-          i += len;
-        }
-      } catch (const LexerError &) {
+      if (i == input.size()) {
         break;
       }
-      if (i >= input.size()) {
-        break;
+      if (input[i] == quote) {
+        return i + 1;
       }
-      value = std::string(input.substr(0, i + 1));
-      break;
+      i += read_characters(input.substr(i)).second;
     }
-    case Type::IntegerLiteral: {
-      if (!std::isdigit(input[0])) {
+  } catch (const LexerError &) {
+    return 0;
+  }
+  return 0;
+}
+
+size_t scan_whitespace(const std::string_view &input) {
+  if (input.size() < 2 || !has_class(input[1], Space)) {
+    return 1; // single separators are the common case, not worth a vector scan
+  }
+  return skip_whitespace(input.data() + 2, input.data() + input.size()) - input.data();
+}
+
+/* returns 0 if input does not start a comment */
+size_t scan_comment(const std::string_view &input) {
+  if (input.starts_with("//")) {
+    return std::min(input.find('\n', 2), input.size());
+  }
+  if (input.starts_with("/*")) {
+    const char *begin = input.data(), *end = input.data() + input.size();
+    size_t i = 2, nested = 1;
+    while (nested > 0) {
+      i = find_comment_delimiter(begin + i, end) - begin;
+      if (i == input.size()) {
         break;
       }
-      for (char c: input) {
-        if (std::isalnum(c) || c == '_') {
-          value.push_back(c);
-        } else {
-          break;
-        }
+      if (i + 1 < input.size() && input[i] == '/' && input[i + 1] == '*') {
+        ++nested;
+        i += 2;
+      } else if (i + 1 < input.size() && input[i] == '*' && input[i + 1] == '/') {
+        --nested;
+        i += 2;
+      } else {
+        ++i;
       }
-      break;
     }
-    case Type::Punctuation: {
-      for (const char *punct: punctuations) {
-        if (input.starts_with(punct)) {
-          value = punct;
-          break;
-        }
+    if (nested != 0) {
+      throw LexerError("Unterminated comment"); // this is specifically for unterminated comment
+    }
+    return i;
+  }
+  return 0;
+}
+
+struct Scan {
+  TokenKind kind;
+  size_t length; // 0 if no token matches
+};
+
+/* longest match at the beginning of input */
+Scan scan_token(const std::string_view &input) {
+  switch (start_states[static_cast<unsigned char>(input[0])]) {
+    case LexState::Word: {
+      size_t len = scan_word(input);
+      int keyword = keyword_id(input.substr(0, len));
+      if (keyword >= 0) {
+        return {keyword_kind(keyword), len};
       }
-      break;
+      return {TokenKind::Identifier, len};
     }
-    case Type::Whitespace: { // added by copilot
-      for (char c: input) {
-        if (std::isspace(c)) {
-          value.push_back(c);
-        } else {
-          break;
-        }
+    case LexState::Integer:
+      return {TokenKind::IntegerLiteral, scan_word(input)};
+    case LexState::Char:
+      return {TokenKind::CharLiteral, scan_quoted(input)};
+    case LexState::String:
+      return {TokenKind::StringLiteral, scan_quoted(input)};
+    case LexState::Whitespace:
+      return {TokenKind::Whitespace, scan_whitespace(input)};
+    case LexState::Slash:
+      if (size_t len = scan_comment(input)) {
+        return {TokenKind::Comment, len};
       }
+      [[fallthrough]];
+    case LexState::Punctuation: {
+      auto [punct, len] = match_punctuation(input);
+      return {punctuation_kind(punct), len};
+    }
+    case LexState::Fail:
       break;
+  }
+  return {TokenKind::Whitespace, 0};
+}
+
+/* the longest token at position, or LexerError carrying that position if there is none */
+Scan scan_at(std::string_view input, size_t position) {
+  Scan scan;
+  try {
+    scan = scan_token(input.substr(position));
+  } catch (const LexerError &e) {
+    throw LexerError(e.what(), position);
+  }
+  if (scan.length == 0) {
+    throw LexerError("Failed to lex token at position " + std::to_string(position), position);
+  }
+  return scan;
+}
+
+bool is_trivia(const Scan &scan) {
+  return scan.kind == TokenKind::Whitespace || scan.kind == TokenKind::Comment;
+}
+
+Token make_token(std::string_view input, size_t position, const Scan &scan) {
+  Token token(scan.kind);
+  token.offset = static_cast<std::uint32_t>(position);
+  token.value = input.substr(position, scan.length);
+  return token;
+}
+
+void check_size(std::string_view input) {
+  if (input.size() > std::numeric_limits<std::uint32_t>::max()) {
+    throw LexerError("Input is larger than 4 GiB");
+  }
+}
+
+/* position of the first invalid UTF-8 sequence in input[begin, end), or end */
+size_t find_invalid_utf8(std::string_view input, size_t begin, size_t end) {
+  return validate_utf8(input.data() + begin, input.data() + end) - input.data();
+}
+
+LexerError invalid_utf8_error(size_t position) {
+  return LexerError("Invalid UTF-8 at position " + std::to_string(position), position);
+}
+
+} // namespace
+
+Lexer::Lexer(std::string_view input) : input{input}, position{0} {
+  check_size(input);
+  if (size_t invalid = find_invalid_utf8(input, 0, input.size()); invalid != input.size()) {
+    throw invalid_utf8_error(invalid);
+  }
+}
+
+std::optional<Token> Lexer::next() {
+  while (position < input.size()) {
+    Scan scan = scan_at(input, position);
+    size_t start = position;
+    position += scan.length;
+    if (!is_trivia(scan)) {
+      return make_token(input, start, scan);
     }
-    case Type::Comment: { // added by copilot
-      if (input.starts_with("//")) {
-        size_t i = 2;
-        while (i < input.size() && input[i] != '\n') {
-          ++i;
-        }
-        value = std::string(input.substr(0, i));
-      } else if (input.starts_with("/*")) {
-        size_t i = 2, nested = 1;
-        while (i < input.size() && nested > 0) {
-          if (i + 1 < input.size() && input[i] == '/' && input[i + 1] == '*') {
-            ++nested;
-            i += 2;
-          } else if (i + 1 < input.size() && input[i] == '*' && input[i + 1] == '/') {
-            --nested;
-            i += 2;
-          } else {
-            ++i;
-          }
-        }
-        if (nested != 0) {
-          throw LexerError("Unterminated comment"); // this is specifically for unterminated comment
-        }
-        value = std::string(input.substr(0, i));
-      }
+  }
+  return std::nullopt;
+}
+
+Lexer::iterator Lexer::begin() {
+  return iterator(*this);
+}
+
+std::default_sentinel_t Lexer::end() const {
+  return std::default_sentinel;
+}
+
+static_assert(std::input_iterator<Lexer::iterator>);
+static_assert(std::sentinel_for<std::default_sentinel_t, Lexer::iterator>);
+
+Lexer::iterator::iterator(Lexer &lexer) : lexer{&lexer}, current{lexer.next()} {}
+
+const Token &Lexer::iterator::operator*() const {
+  return *current;
+}
+
+const Token *Lexer::iterator::operator->() const {
+  return &*current;
+}
+
+Lexer::iterator &Lexer::iterator::operator++() {
+  current = lexer->next();
+  return *this;
+}
+
+void Lexer::iterator::operator++(int) {
+  ++*this;
+}
+
+bool Lexer::iterator::operator==(std::default_sentinel_t) const {
+  return !current.has_value();
+}
+
+namespace {
+
+struct IntegerSuffix {
+  std::string_view spelling;
+  Literal::Suffix suffix;
+  int bits;
+  bool is_signed;
+};
+
+constexpr std::array<IntegerSuffix, 12> integer_suffixes{{
+  {"i8", Literal::Suffix::I8, 8, true},
+  {"i16", Literal::Suffix::I16, 16, true},
+  {"i32", Literal::Suffix::I32, 32, true},
+  {"i64", Literal::Suffix::I64, 64, true},
+  {"i128", Literal::Suffix::I128, 128, true},
+  {"isize", Literal::Suffix::Isize, 64, true},
+  {"u8", Literal::Suffix::U8, 8, false},
+  {"u16", Literal::Suffix::U16, 16, false},
+  {"u32", Literal::Suffix::U32, 32, false},
+  {"u64", Literal::Suffix::U64, 64, false},
+  {"u128", Literal::Suffix::U128, 128, false},
+  {"usize", Literal::Suffix::Usize, 64, false},
+}};
+
+bool is_digit_in_base(char c, int base) {
+  if (base == 16) {
+    return has_class(c, Digit) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+  }
+  return c >= '0' && c < '0' + base;
+}
+
+/* value and suffix of an integer literal such as 42, 0x1F, 0b1010u8 or 1_000_i64 */
+Literal decode_integer(std::string_view spelling) {
+  int base = 10;
+  size_t i = 0;
+  if (spelling.size() > 2 && spelling[0] == '0') {
+    switch (spelling[1]) {
+      case 'x': base = 16; i = 2; break;
+      case 'o': base = 8; i = 2; break;
+      case 'b': base = 2; i = 2; break;
+      default: break;
+    }
+  }
+  std::string digits;
+  for (; i < spelling.size() && (spelling[i] == '_' || is_digit_in_base(spelling[i], base)); ++i) {
+    if (spelling[i] != '_') {
+      digits.push_back(spelling[i]);
+    }
+  }
+  if (digits.empty()) {
+    throw LexerError("Integer literal has no digits");
+  }
+
+  // accumulated as two 64-bit halves, so i128 and u128 literals keep their full value
+  Literal literal;
+  for (char c : digits) {
+    std::uint64_t digit = has_class(c, Digit) ? c - '0' : (c | 0x20) - 'a' + 10;
+    std::uint64_t low = (literal.integer & 0xffffffff) * base + digit;
+    std::uint64_t middle = (literal.integer >> 32) * base + (low >> 32);
+    std::uint64_t carry = middle >> 32;
+    if (literal.integer_high > (std::numeric_limits<std::uint64_t>::max() - carry) / base) {
+      throw LexerError("Integer literal is too large");
+    }
+    literal.integer_high = literal.integer_high * base + carry;
+    literal.integer = (middle << 32) | (low & 0xffffffff);
+  }
+  int bits = 64;
+  bool is_signed = false;
+  if (i < spelling.size()) {
+    auto suffix = std::find_if(integer_suffixes.begin(), integer_suffixes.end(),
+                               [&](const IntegerSuffix &s) { return s.spelling == spelling.substr(i); });
+    if (suffix == integer_suffixes.end()) {
+      throw LexerError("Invalid integer suffix: " + std::string(spelling.substr(i)));
+    }
+    literal.suffix = suffix->suffix;
+    bits = suffix->bits;
+    is_signed = suffix->is_signed;
+  }
+  if (bits < 128 && literal.integer_high != 0) {
+    throw LexerError("Integer literal is too large");
+  }
+  // signed literals may be one past the maximum, so that the most negative value can be written
+  std::uint64_t high_limit = 0, limit = std::numeric_limits<std::uint64_t>::max();
+  if (bits == 128) {
+    high_limit = is_signed ? std::uint64_t{1} << 63 : limit;
+    limit = is_signed ? 0 : limit;
+  } else if (is_signed) {
+    limit = std::uint64_t{1} << (bits - 1);
+  } else if (bits < 64) {
+    limit = (std::uint64_t{1} << bits) - 1;
+  }
+  if (literal.integer_high > high_limit || (literal.integer_high == high_limit && literal.integer > limit)) {
+    throw LexerError("Integer literal is too large for its type");
+  }
+  return literal;
+}
+
+/* unescaped contents of a char or string literal, added to the pool */
+SymbolId decode_quoted(std::string_view spelling, SymbolTable &pool) {
+  std::string_view body = spelling.substr(1, spelling.size() - 2);
+  std::string decoded;
+  size_t i = 0;
+  while (i < body.size()) {
+    // everything up to the next escape, multi-byte characters included, is copied as one run
+    size_t escape = std::min(body.find('\\', i), body.size());
+    decoded.append(body, i, escape - i);
+    if (escape == body.size()) {
       break;
     }
+    auto [c, len] = read_characters(body.substr(escape));
+    decoded.push_back(c);
+    i = escape + len;
   }
+  return pool.intern(decoded);
 }
 
-static
-Token try_lex(const std::string_view &input, Token::Type type) {
-  Token token(type);
-  token.read_from(input);
+Literal decode_literal(TokenKind kind, std::string_view spelling, SymbolTable &pool) {
+  Literal literal;
+  if (kind == TokenKind::IntegerLiteral) {
+    literal = decode_integer(spelling);
+  } else if (kind == TokenKind::CharLiteral || kind == TokenKind::StringLiteral) {
+    literal.string = decode_quoted(spelling, pool);
+  }
+  return literal;
+}
+
+} // namespace
+
+TokenBuffer::TokenBuffer(std::string_view source) : source{source} {}
+
+void TokenBuffer::push_back(const Token &token) {
+  SymbolId symbol = SymbolTable::none;
+  if (!is_keyword(token.kind) && !is_punctuation(token.kind)) {
+    symbol = intern(token.value, token.kind, token.offset);
+  }
+  kinds.push_back(token.kind);
+  offsets.push_back(token.offset);
+  lengths.push_back(static_cast<std::uint32_t>(token.value.size()));
+  symbol_ids.push_back(symbol);
+}
+
+SymbolId TokenBuffer::intern(std::string_view spelling, TokenKind kind, std::uint32_t offset) {
+  if (std::optional<SymbolId> known = symbol_table.find(spelling)) {
+    return *known;
+  }
+  // each distinct literal is decoded once, before its spelling is interned, so a spelling that
+  // fails to decode is never left in the table
+  try {
+    literals.push_back(decode_literal(kind, spelling, pool));
+  } catch (const LexerError &e) {
+    throw LexerError(e.what(), offset);
+  }
+  return symbol_table.intern(spelling);
+}
+
+void TokenBuffer::push_trivia(std::uint32_t offset) {
+  if (trivia_first.size() <= size()) {
+    trivia_first.resize(size() + 1, static_cast<std::uint32_t>(trivia_offsets.size()));
+  }
+  trivia_offsets.push_back(offset);
+}
+
+// a piece ends where the next piece or token starts
+Token TokenBuffer::trivia(std::size_t index, std::size_t piece) const {
+  std::size_t i = first_trivia(index) + piece;
+  std::size_t end = piece + 1 < trivia_count(index) ? trivia_offsets[i + 1]
+                    : index < size()                 ? offsets[index]
+                                                     : source.size();
+  Token token(source[trivia_offsets[i]] == '/' ? TokenKind::Comment : TokenKind::Whitespace);
+  token.offset = trivia_offsets[i];
+  token.value = source.substr(trivia_offsets[i], end - trivia_offsets[i]);
   return token;
 }
 
-/* generated by copilot */
-std::vector<Token> lex(const std::string_view &input) {
-  std::vector<Token> tokens;
-  size_t i = 0;
-  while (i < input.size()) {
-    Token token;
-    for (auto type: Token::types) {
-      auto t = try_lex(input.substr(i), type);
-      if (t.value.size() > token.value.size()) {
-        token = t;
+void TokenBuffer::clear() {
+  kinds.clear();
+  offsets.clear();
+  lengths.clear();
+  symbol_ids.clear();
+  trivia_offsets.clear();
+  trivia_first.clear();
+  symbol_table.clear();
+  literals.clear();
+  pool.clear();
+}
+
+void TokenBuffer::reserve(std::size_t count) {
+  kinds.reserve(count);
+  offsets.reserve(count);
+  lengths.reserve(count);
+  symbol_ids.reserve(count);
+}
+
+// symbol ids of other are mapped into this table in order of first use, as if its tokens had been pushed one by one
+void TokenBuffer::append(const TokenBuffer &other, std::size_t first) {
+  kinds.insert(kinds.end(), other.kinds.begin() + first, other.kinds.end());
+  offsets.insert(offsets.end(), other.offsets.begin() + first, other.offsets.end());
+  lengths.insert(lengths.end(), other.lengths.begin() + first, other.lengths.end());
+  std::vector<SymbolId> mapped(other.symbol_table.size(), SymbolTable::none);
+  for (std::size_t i = first; i < other.size(); ++i) {
+    SymbolId symbol = other.symbol_ids[i];
+    if (symbol != SymbolTable::none) {
+      if (mapped[symbol] == SymbolTable::none) {
+        mapped[symbol] = intern(other.symbol_table.spelling(symbol), other.kinds[i], other.offsets[i]);
       }
+      symbol = mapped[symbol];
     }
-    if (token.value.empty()) {
-      throw LexerError("Failed to lex token at position " + std::to_string(i));
+    symbol_ids.push_back(symbol);
+  }
+}
+
+void TokenBuffer::splice(std::string_view edited, std::size_t first, std::size_t last, const TokenBuffer &replacement,
+                         std::ptrdiff_t shift) {
+  source = edited;
+  trivia_offsets.clear();
+  trivia_first.clear();
+  for (std::size_t i = last; i < offsets.size(); ++i) {
+    offsets[i] = static_cast<std::uint32_t>(offsets[i] + shift);
+  }
+  kinds.erase(kinds.begin() + first, kinds.begin() + last);
+  kinds.insert(kinds.begin() + first, replacement.kinds.begin(), replacement.kinds.end());
+  offsets.erase(offsets.begin() + first, offsets.begin() + last);
+  offsets.insert(offsets.begin() + first, replacement.offsets.begin(), replacement.offsets.end());
+  lengths.erase(lengths.begin() + first, lengths.begin() + last);
+  lengths.insert(lengths.begin() + first, replacement.lengths.begin(), replacement.lengths.end());
+  // spellings the removed tokens no longer use stay in the table, so kept tokens keep their ids
+  std::vector<SymbolId> symbols;
+  symbols.reserve(replacement.size());
+  for (std::size_t i = 0; i < replacement.size(); ++i) {
+    SymbolId symbol = replacement.symbol_ids[i];
+    if (symbol != SymbolTable::none) {
+      symbol = intern(replacement.symbol_table.spelling(symbol), replacement.kinds[i], replacement.offsets[i]);
     }
-    i += token.value.size();
-    if (token.type != Token::Type::Whitespace && token.type != Token::Type::Comment) {
-      tokens.push_back(token);
+    symbols.push_back(symbol);
+  }
+  symbol_ids.erase(symbol_ids.begin() + first, symbol_ids.begin() + last);
+  symbol_ids.insert(symbol_ids.begin() + first, symbols.begin(), symbols.end());
+}
+
+Token TokenBuffer::operator[](std::size_t index) const {
+  Token token(kinds[index]);
+  token.offset = offsets[index];
+  token.value = value(index);
+  return token;
+}
+
+// same rules as Token::match; only identifier and literal patterns with a spelling look past the kind
+bool TokenBuffer::matches(std::size_t index, const Token &pattern) const {
+  if (pattern.kind != kinds[index]) {
+    return false;
+  }
+  return pattern.value.empty() || is_keyword(pattern.kind) || is_punctuation(pattern.kind) ||
+         pattern.value == value(index);
+}
+
+TokenBuffer::iterator TokenBuffer::begin() const {
+  return iterator(*this, 0);
+}
+
+TokenBuffer::iterator TokenBuffer::end() const {
+  return iterator(*this, size());
+}
+
+static_assert(std::forward_iterator<TokenBuffer::iterator>);
+
+TokenBuffer lex(const std::string_view &input, bool keep_trivia) {
+  TokenBuffer tokens(input);
+  Lexer lexer(input);
+  if (!keep_trivia) {
+    while (auto token = lexer.next()) {
+      tokens.push_back(*token);
+    }
+    return tokens;
+  }
+  for (size_t position = 0; position < input.size();) {
+    Scan scan = scan_at(input, position);
+    if (is_trivia(scan)) {
+      tokens.push_trivia(static_cast<std::uint32_t>(position));
+    } else {
+      tokens.push_back(make_token(input, position, scan));
+    }
+    position += scan.length;
+  }
+  return tokens;
+}
+
+namespace {
+
+/* the fix-up pass almost always rejoins a chunk within its first few scans */
+constexpr size_t recorded_boundaries = 4096;
+
+/* one slice of the input lexed speculatively, as if a token started at begin */
+struct LexChunk {
+  size_t begin;
+  size_t end; // begin of the next chunk; the last token may run past it
+  size_t invalid_utf8; // first invalid UTF-8 position in [begin, end), or end
+  TokenBuffer tokens;
+  std::vector<std::uint32_t> boundaries; // start of the first scans, trivia included, in increasing order
+  size_t stop; // position after the last scan
+  std::optional<LexerError> error; // why the run stopped at stop, if it did not reach end
+};
+
+/* moves a cut to just after the next newline in the window, since lines rarely start inside a
+   literal or comment, and otherwise to a character boundary so the chunk can be validated alone */
+size_t chunk_start(std::string_view input, size_t cut, size_t window) {
+  size_t limit = std::min(input.size(), cut + window);
+  if (auto newline = static_cast<const char *>(std::memchr(input.data() + cut, '\n', limit - cut))) {
+    return newline - input.data() + 1;
+  }
+  while (cut < input.size() && (static_cast<unsigned char>(input[cut]) & 0xc0) == 0x80) {
+    ++cut;
+  }
+  return cut;
+}
+
+void lex_chunk(std::string_view input, LexChunk &chunk) {
+  chunk.invalid_utf8 = find_invalid_utf8(input, chunk.begin, chunk.end);
+  if (chunk.invalid_utf8 != chunk.end) {
+    return;
+  }
+  size_t position = chunk.begin;
+  try {
+    while (position < chunk.end) {
+      if (chunk.boundaries.size() < recorded_boundaries) {
+        chunk.boundaries.push_back(static_cast<std::uint32_t>(position));
+      }
+      Scan scan = scan_at(input, position);
+      if (!is_trivia(scan)) {
+        chunk.tokens.push_back(make_token(input, position, scan));
+      }
+      position += scan.length;
+    }
+  } catch (const LexerError &e) {
+    chunk.error = e;
+  }
+  chunk.stop = position;
+}
+
+} // namespace
+
+TokenBuffer lex_parallel(const std::string_view &input, unsigned threads, size_t chunk_size) {
+  if (threads == 0) {
+    threads = std::thread::hardware_concurrency();
+  }
+  chunk_size = std::max<size_t>(chunk_size, 1);
+  if (threads <= 1 || input.size() / 2 < chunk_size) {
+    return lex(input);
+  }
+  check_size(input);
+  std::vector<LexChunk> chunks;
+  size_t cuts = input.size() / chunk_size;
+  for (size_t i = 0, begin = 0; i < cuts && begin < input.size(); ++i) {
+    size_t end = i + 1 == cuts ? input.size() : chunk_start(input, std::max(begin, (i + 1) * chunk_size), chunk_size / 8);
+    if (end > begin) {
+      chunks.push_back(LexChunk{begin, end, end, TokenBuffer(input), {}, begin, std::nullopt});
+      begin = end;
+    }
+  }
+
+  // speculative pass: every chunk is lexed and interned on its own, workers take chunks in order
+  std::atomic<size_t> next_chunk{0};
+  auto worker = [&] {
+    for (size_t i; (i = next_chunk.fetch_add(1)) < chunks.size();) {
+      lex_chunk(input, chunks[i]);
+    }
+  };
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < std::min<size_t>(threads, chunks.size()); ++i) {
+    workers.emplace_back(worker);
+  }
+  worker();
+  for (auto &thread : workers) {
+    thread.join();
+  }
+
+  for (const auto &chunk : chunks) {
+    if (chunk.invalid_utf8 != chunk.end) {
+      throw invalid_utf8_error(chunk.invalid_utf8);
     }
   }
+
+  // fix-up pass: follow the true token boundaries through the chunks; a speculative run is kept from
+  // the first boundary it shares with them, since lexing only depends on the current position
+  TokenBuffer tokens(input);
+  size_t token_count = 0;
+  for (const auto &chunk : chunks) {
+    token_count += chunk.tokens.size();
+  }
+  tokens.reserve(token_count);
+  size_t position = 0;
+  for (auto &chunk : chunks) {
+    while (position < chunk.end && !std::binary_search(chunk.boundaries.begin(), chunk.boundaries.end(), position)) {
+      Scan scan = scan_at(input, position);
+      if (!is_trivia(scan)) {
+        tokens.push_back(make_token(input, position, scan));
+      }
+      position += scan.length;
+    }
+    if (position >= chunk.end) {
+      continue; // relexed to the end, or a token from an earlier chunk covered this one
+    }
+    size_t first = 0, last = chunk.tokens.size();
+    while (first < last) {
+      size_t middle = first + (last - first) / 2;
+      if (chunk.tokens.offset(middle) < position) {
+        first = middle + 1;
+      } else {
+        last = middle;
+      }
+    }
+    tokens.append(chunk.tokens, first);
+    chunk.tokens = TokenBuffer();
+    if (chunk.error) {
+      throw *chunk.error;
+    }
+    position = chunk.stop;
+  }
   return tokens;
-}
\ No newline at end of file
+}
+
+Relexed relex(TokenBuffer previous, std::string_view source, const SourceEdit &edit) {
+  check_size(source);
+  size_t edit_end = edit.offset + edit.inserted.size();
+  if (edit_end > source.size() || source.substr(edit.offset, edit.inserted.size()) != edit.inserted) {
+    throw LexerError("Edit does not match the edited source", edit.offset);
+  }
+  auto shift = static_cast<std::ptrdiff_t>(edit.inserted.size()) - static_cast<std::ptrdiff_t>(edit.removed);
+
+  // a scan reads at most one byte past its token, so tokens ending before the byte at the edit offset
+  // are kept, and lexing resumes where the last of them ends
+  size_t first = 0, last = previous.size();
+  while (first < last) {
+    size_t middle = first + (last - first) / 2;
+    if (previous.offset(middle) + previous.length(middle) < edit.offset) {
+      first = middle + 1;
+    } else {
+      last = middle;
+    }
+  }
+  size_t position = first == 0 ? 0 : previous.offset(first - 1) + previous.length(first - 1);
+
+  // bytes outside the edit were valid before; an ASCII byte after it ends any sequence the edit
+  // could have changed
+  size_t checked = edit_end;
+  while (checked < source.size() && static_cast<unsigned char>(source[checked]) >= 0x80) {
+    ++checked;
+  }
+  if (size_t invalid = find_invalid_utf8(source, position, checked); invalid != checked) {
+    throw invalid_utf8_error(invalid);
+  }
+
+  // relex until a scan ends past the edit at the start of an old token, after which both streams
+  // see the same bytes
+  TokenBuffer tokens(source);
+  size_t old_end = first;
+  while (position < source.size()) {
+    Scan scan = scan_at(source, position);
+    if (!is_trivia(scan)) {
+      tokens.push_back(make_token(source, position, scan));
+    }
+    position += scan.length;
+    if (position < edit_end) {
+      continue;
+    }
+    size_t old_position = position - shift;
+    while (old_end < previous.size() && previous.offset(old_end) < old_position) {
+      ++old_end;
+    }
+    if (old_end < previous.size() && previous.offset(old_end) == old_position) {
+      break;
+    }
+  }
+  if (position == source.size()) {
+    old_end = previous.size();
+  }
+
+  TokenChange changed{first, old_end, first + tokens.size()};
+  previous.splice(source, first, old_end, tokens, shift);
+  return Relexed{std::move(previous), changed};
+}
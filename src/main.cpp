@@ -6,18 +6,33 @@
 #include "parse_tree.hpp"
 #include "lexer.hpp"
 #include "parser.hpp"
+#include "source.hpp"
 
+// usage: main [file], reads stdin if no file is given
 int main(int argc, char* argv[]) {
-  std::string content {
-    std::istreambuf_iterator<char>(std::cin),
-    std::istreambuf_iterator<char>()
-  }; // another AI told me to use this
+  SourceManager sources;
+  const SourceBuffer *source;
+  try {
+    source = argc > 1 ? &sources.add_file(argv[1]) : &sources.add_stdin();
+  } catch (const std::exception& e) {
+    std::cout << "Exception: " << e.what() << std::endl;
+    return 1;
+  }
 
-  auto tokens = lex(std::string_view(content));
+  TokenBuffer tokens;
+  try {
+    tokens = lex_parallel(source->text());
+  } catch (const LexerError& e) {
+    auto [line, column] = source->location(e.position);
+    std::cout << source->name() << ":" << line << ":" << column << ": " << e.what() << std::endl;
+    return 1;
+  }
 
   std::cout << "Tokens:" << std::endl;
   for (const auto& token : tokens) {
-    std::cout << "Type: " << static_cast<int>(token.type) << ", Value: '" << token.value << "'" << std::endl;
+    auto [line, column] = source->location(token.offset);
+    std::cout << "Type: " << static_cast<int>(token.type) << ", Value: '" << token.value << "'"
+              << ", Location: " << line << ":" << column << std::endl;
   }
 
   try {
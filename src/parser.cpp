@@ -6,23 +6,357 @@
 
 // Forward declarations for helper functions
 std::unique_ptr<TreeNode> construct_cst(const ParsingState& state, std::size_t i, std::size_t j,
-                                        const std::vector<std::vector<ParsingState>>& table,
-                                        const std::vector<Token>& tokens, int depth = 0);
-
-// Helper function to check if a state is finished (moved outside class)
-bool is_finished_state(const ParsingState& state, const std::array<std::vector<Production>, 97>& rules) {
-  const auto& productions = rules[state.nonterminal_type];
-  const auto& production = productions[state.production_index];
-  return state.position_in_production == production.size();
+                                        const CompletedItems& completed,
+                                        const TokenBuffer& tokens, int depth = 0);
+
+namespace {
+
+constexpr std::uint8_t no_symbol = 0xff;
+
+/* parse_rules compiled into flat arrays. Every position of every production is a dotted rule,
+   numbered production by production, so moving the dot over a symbol adds one to the id. The
+   distinct terminal patterns are numbered by their first use */
+struct GrammarTables {
+  // by dotted rule
+  std::vector<std::uint8_t> lhs;
+  std::vector<std::uint8_t> production;
+  std::vector<std::uint8_t> position;
+  std::vector<std::uint8_t> complete; // the dot is at the end
+  std::vector<std::uint8_t> next_nonterminal; // no_symbol unless a nonterminal follows the dot
+  std::vector<std::uint8_t> next_terminal; // pattern slot, no_symbol unless a terminal follows the dot
+
+  // the initial dotted rules of the productions of nonterminal n are
+  // initial_rules[initial_begin[n]] up to initial_rules[initial_begin[n + 1]]
+  std::vector<std::uint32_t> initial_rules;
+  std::array<std::uint32_t, 98> initial_begin;
+  // the nonterminals predicted along with each one: itself, and transitively every nonterminal
+  // a production of a predicted nonterminal starts with
+  std::array<NonterminalSet, 97> prediction_closure;
+  NonterminalSet nullable; // nonterminals that derive the empty string
+
+  std::vector<Token> patterns;
+  std::array<TerminalMask, token_kind_count> kind_masks; // patterns matched by every token of a kind
+  std::vector<std::size_t> spelled; // patterns that also need the token's spelling
+};
+
+std::uint8_t pattern_slot(GrammarTables& grammar, const Token& pattern) {
+  auto found = std::find_if(grammar.patterns.begin(), grammar.patterns.end(), [&](const Token& other) {
+    return other.kind == pattern.kind && other.value == pattern.value;
+  });
+  std::size_t slot = found - grammar.patterns.begin();
+  if (found == grammar.patterns.end()) {
+    if (slot == TerminalMask().size()) {
+      throw ParseError("Grammar has more terminal patterns than TerminalMask can hold");
+    }
+    grammar.patterns.push_back(pattern);
+    if (pattern.value.empty() || is_keyword(pattern.kind) || is_punctuation(pattern.kind)) {
+      grammar.kind_masks[static_cast<std::size_t>(pattern.kind)].set(slot);
+    } else {
+      grammar.spelled.push_back(slot);
+    }
+  }
+  return static_cast<std::uint8_t>(slot);
 }
 
+GrammarTables build_grammar_tables() {
+  GrammarTables grammar;
+  for (std::size_t rule = 0; rule < parse_rules.size(); ++rule) {
+    grammar.initial_begin[rule] = static_cast<std::uint32_t>(grammar.initial_rules.size());
+    for (std::size_t index = 0; index < parse_rules[rule].size(); ++index) {
+      const auto& production = parse_rules[rule][index];
+      if (index >= no_symbol || production.size() >= no_symbol) {
+        throw ParseError("Grammar rule is too large for the compiled tables");
+      }
+      grammar.initial_rules.push_back(static_cast<std::uint32_t>(grammar.lhs.size()));
+      for (std::size_t position = 0; position <= production.size(); ++position) {
+        std::uint8_t nonterminal = no_symbol, terminal = no_symbol;
+        if (position < production.size()) {
+          if (std::holds_alternative<Nonterminal>(production[position])) {
+            nonterminal = static_cast<std::uint8_t>(std::get<Nonterminal>(production[position]));
+          } else {
+            terminal = pattern_slot(grammar, std::get<Token>(production[position]));
+          }
+        }
+        grammar.lhs.push_back(static_cast<std::uint8_t>(rule));
+        grammar.production.push_back(static_cast<std::uint8_t>(index));
+        grammar.position.push_back(static_cast<std::uint8_t>(position));
+        grammar.complete.push_back(position == production.size());
+        grammar.next_nonterminal.push_back(nonterminal);
+        grammar.next_terminal.push_back(terminal);
+      }
+    }
+  }
+  grammar.initial_begin[parse_rules.size()] = static_cast<std::uint32_t>(grammar.initial_rules.size());
+
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (std::size_t rule = 0; rule < parse_rules.size(); ++rule) {
+      for (std::uint32_t i = grammar.initial_begin[rule]; i < grammar.initial_begin[rule + 1] && !grammar.nullable.test(rule); ++i) {
+        std::uint32_t dotted = grammar.initial_rules[i];
+        while (grammar.next_nonterminal[dotted] != no_symbol && grammar.nullable.test(grammar.next_nonterminal[dotted])) {
+          ++dotted;
+        }
+        if (grammar.complete[dotted]) {
+          grammar.nullable.set(rule);
+          changed = true;
+        }
+      }
+    }
+  }
+
+  for (std::size_t rule = 0; rule < parse_rules.size(); ++rule) {
+    grammar.prediction_closure[rule].set(rule);
+  }
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (std::size_t rule = 0; rule < parse_rules.size(); ++rule) {
+      NonterminalSet closure = grammar.prediction_closure[rule];
+      for (std::uint32_t i = grammar.initial_begin[rule]; i < grammar.initial_begin[rule + 1]; ++i) {
+        std::uint8_t first = grammar.next_nonterminal[grammar.initial_rules[i]];
+        if (first != no_symbol) {
+          closure |= grammar.prediction_closure[first];
+        }
+      }
+      if (closure != grammar.prediction_closure[rule]) {
+        grammar.prediction_closure[rule] = closure;
+        changed = true;
+      }
+    }
+  }
+  return grammar;
+}
+
+// parse_rules is initialized in another translation unit, so the tables are built on first use
+const GrammarTables& grammar_tables() {
+  static const GrammarTables grammar = build_grammar_tables();
+  return grammar;
+}
+
+// token indexes fit 32 bits because token offsets do
+std::uint64_t pack_item(const ParsingState& state) {
+  return static_cast<std::uint64_t>(state.dotted_rule) << 32 | static_cast<std::uint64_t>(state.start_token_index);
+}
+
+std::size_t item_slot(std::uint64_t item, std::size_t mask) {
+  return static_cast<std::size_t>((item * 0x9e3779b97f4a7c15ULL) >> 32) & mask;
+}
+
+// computed once per token, so the scanner tests a bit instead of calling Token::match per item
+TerminalMask token_mask(const TokenBuffer& tokens, std::size_t index) {
+  const GrammarTables& grammar = grammar_tables();
+  TerminalMask mask = grammar.kind_masks[static_cast<std::size_t>(tokens.kind(index))];
+  for (std::size_t slot : grammar.spelled) {
+    if (tokens.matches(index, grammar.patterns[slot])) {
+      mask.set(slot);
+    }
+  }
+  return mask;
+}
+
+} // namespace
+
+bool is_nullable(Nonterminal nonterminal) {
+  return grammar_tables().nullable.test(static_cast<std::size_t>(nonterminal));
+}
+
+NonterminalSet prediction_closure(Nonterminal nonterminal) {
+  return grammar_tables().prediction_closure[static_cast<std::size_t>(nonterminal)];
+}
+
+ParsingState ParsingState::at(Nonterminal nonterminal, std::size_t production, std::size_t position,
+                              std::size_t start) {
+  const GrammarTables& grammar = grammar_tables();
+  std::uint32_t initial = grammar.initial_rules[grammar.initial_begin[static_cast<std::size_t>(nonterminal)] + production];
+  return ParsingState{initial + static_cast<std::uint32_t>(position), start};
+}
+
+int ParsingState::nonterminal_type() const {
+  return grammar_tables().lhs[dotted_rule];
+}
+
+std::size_t ParsingState::production_index() const {
+  return grammar_tables().production[dotted_rule];
+}
+
+std::size_t ParsingState::position_in_production() const {
+  return grammar_tables().position[dotted_rule];
+}
+
+// dotted rules are numbered in (nonterminal, production, position) order, so this is the same order
 bool ParsingState::operator == (const ParsingState &other) const {
-  return std::tie(nonterminal_type, production_index, position_in_production, start_token_index) ==
-         std::tie(other.nonterminal_type, other.production_index, other.position_in_production, other.start_token_index);
+  return std::tie(dotted_rule, start_token_index) == std::tie(other.dotted_rule, other.start_token_index);
 }
 bool ParsingState::operator < (const ParsingState &other) const {
-  return std::tie(nonterminal_type, production_index, position_in_production, start_token_index) <
-         std::tie(other.nonterminal_type, other.production_index, other.position_in_production, other.start_token_index);
+  return std::tie(dotted_rule, start_token_index) < std::tie(other.dotted_rule, other.start_token_index);
+}
+
+bool ItemSet::insert(const ParsingState& state) {
+  // keep the load factor at most one half
+  if ((count + 1) * 2 > slots.size()) {
+    grow();
+  }
+  std::uint64_t entry = pack_item(state) + 1;
+  std::size_t mask = slots.size() - 1;
+  for (std::size_t slot = item_slot(entry, mask);; slot = (slot + 1) & mask) {
+    if (slots[slot] == entry) {
+      return false;
+    }
+    if (slots[slot] == 0) {
+      slots[slot] = entry;
+      ++count;
+      return true;
+    }
+  }
+}
+
+// keeps the slots, since the next chart is usually about as large
+void ItemSet::clear() {
+  std::fill(slots.begin(), slots.end(), 0);
+  count = 0;
+}
+
+void ItemSet::grow() {
+  std::vector<std::uint64_t> old = std::move(slots);
+  slots.assign(old.empty() ? 256 : old.size() * 2, 0);
+  std::size_t mask = slots.size() - 1;
+  for (std::uint64_t entry : old) {
+    if (entry != 0) {
+      std::size_t slot = item_slot(entry, mask);
+      while (slots[slot] != 0) {
+        slot = (slot + 1) & mask;
+      }
+      slots[slot] = entry;
+    }
+  }
+}
+
+CompletedItems::CompletedItems(const std::vector<std::vector<ParsingState>>& table,
+                               const std::vector<WaitingItems>& waiting) {
+  const GrammarTables& grammar = grammar_tables();
+  // bucketed by origin in chart order, then each bucket is sorted by nonterminal
+  origin_begin.assign(table.size() + 1, 0);
+  for (const auto& chart : table) {
+    for (const auto& state : chart) {
+      origin_begin[state.start_token_index + 1] += grammar.complete[state.dotted_rule];
+    }
+  }
+  for (std::size_t origin = 0; origin < table.size(); ++origin) {
+    origin_begin[origin + 1] += origin_begin[origin];
+  }
+  items.resize(origin_begin.back());
+  std::vector<std::uint32_t> next(origin_begin.begin(), origin_begin.end() - 1);
+  for (std::size_t chart_index = 0; chart_index < table.size(); ++chart_index) {
+    for (const auto& state : table[chart_index]) {
+      if (grammar.complete[state.dotted_rule]) {
+        items[next[state.start_token_index]++] = Completed{grammar.lhs[state.dotted_rule], chart_index, state};
+      }
+    }
+  }
+  for (std::size_t origin = 0; origin < table.size(); ++origin) {
+    std::stable_sort(items.begin() + origin_begin[origin], items.begin() + origin_begin[origin + 1],
+                     [](const Completed& a, const Completed& b) { return a.nonterminal < b.nonterminal; });
+  }
+  // a reduced item is only left out of the charts if its own origin continues the path; otherwise
+  // it is the top, which the completer added
+  auto continues = [&](const ParsingState& reduced) {
+    const auto& leo = waiting[reduced.start_token_index].leo;
+    return std::any_of(leo.begin(), leo.end(),
+                       [&](const auto& entry) { return entry.first == grammar.lhs[reduced.dotted_rule]; });
+  };
+  for (std::size_t chart_index = 0; chart_index < waiting.size(); ++chart_index) {
+    const WaitingItems& chart_waiting = waiting[chart_index];
+    for (const auto& [nonterminal, top] : chart_waiting.leo) {
+      const ParsingState& reduced = chart_waiting.items[chart_waiting.begin[nonterminal]];
+      if (continues(reduced)) {
+        reductions[key(grammar.lhs[reduced.dotted_rule], reduced.start_token_index)].push_back(
+            Reduction{nonterminal, chart_index, reduced});
+      }
+    }
+  }
+}
+
+CompletedItems::Found CompletedItems::in_table(std::uint64_t key, std::size_t last) const {
+  // the entries of key up to chart last; the result is the first entry of the last chart among them
+  std::size_t origin = key >> 7;
+  if (origin + 1 >= origin_begin.size()) {
+    return std::nullopt;
+  }
+  auto bucket = items.begin() + origin_begin[origin], bucket_end = items.begin() + origin_begin[origin + 1];
+  auto bound = std::pair{static_cast<std::uint8_t>(key & 0x7f), last};
+  auto first = std::lower_bound(bucket, bucket_end, bound.first,
+                                [](const Completed& entry, std::uint8_t value) { return entry.nonterminal < value; });
+  auto after = std::upper_bound(first, bucket_end, bound, [](const auto& value, const Completed& entry) {
+    return value < std::pair{entry.nonterminal, entry.chart};
+  });
+  if (after == first) {
+    return std::nullopt;
+  }
+  std::size_t chart = std::prev(after)->chart;
+  first = std::lower_bound(first, after, chart, [](const Completed& entry, std::size_t value) { return entry.chart < value; });
+  return std::pair{first->state, chart};
+}
+
+CompletedItems::Found CompletedItems::latest(Nonterminal nonterminal, std::size_t origin, std::size_t last) const {
+  // a reduced item is in each chart after its waiting chart where the nonterminal it waited for is
+  // completed, which may itself be a reduced item; chains are as long as the input, so they are
+  // followed with an explicit stack. Results for keys with reductions are kept per last chart, and
+  // the lookups for the nodes of a chain share them, so building the CST for a chain stays linear
+  struct Frame {
+    std::uint64_t key;
+    std::size_t next; // reduction looked at next
+    Found found;
+  };
+  std::uint64_t query = key(static_cast<std::size_t>(nonterminal), origin);
+  if (!reductions.contains(query)) {
+    return in_table(query, last);
+  }
+  if (auto done = lookups.find({query, last}); done != lookups.end()) {
+    return done->second;
+  }
+  // an entry is made before the lookup finishes, so a cycle of unit rules finds nothing
+  lookups.emplace(std::pair{query, last}, std::nullopt);
+  std::vector<Frame> stack{{query, 0, in_table(query, last)}};
+  while (true) {
+    Frame& frame = stack.back();
+    const auto& pending = reductions.find(frame.key)->second;
+    if (frame.next < pending.size()) {
+      const Reduction& reduction = pending[frame.next];
+      std::uint64_t below = key(reduction.nonterminal, reduction.origin);
+      Found completed;
+      if (!reductions.contains(below)) {
+        completed = in_table(below, last);
+      } else if (auto done = lookups.find({below, last}); done != lookups.end()) {
+        completed = done->second;
+      } else {
+        lookups.emplace(std::pair{below, last}, std::nullopt);
+        stack.push_back({below, 0, in_table(below, last)});
+        continue;
+      }
+      // empty completions were never waited for, the predictor moved the dot past them
+      if (completed && completed->second > reduction.origin &&
+          (!frame.found || completed->second > frame.found->second)) {
+        frame.found = std::pair{reduction.reduced, completed->second};
+      }
+      ++frame.next;
+      continue;
+    }
+    // the frame below looks its reduction up again and now finds this result
+    Found found = frame.found;
+    lookups[{frame.key, last}] = found;
+    stack.pop_back();
+    if (stack.empty()) {
+      return found;
+    }
+  }
+}
+
+std::optional<ParsingState> CompletedItems::in_chart(Nonterminal nonterminal, std::size_t origin,
+                                                     std::size_t chart) const {
+  Found found = latest(nonterminal, origin, chart);
+  if (found && found->second == chart) {
+    return found->first;
+  }
+  return std::nullopt;
 }
 
 // pseodocode from wikipedia
@@ -66,123 +400,181 @@ bool ParsingState::operator < (const ParsingState &other) const {
 //     end
 
 bool EarleyParser::is_finished(const ParsingState& state) const {
-  const auto& productions = parse_rules[state.nonterminal_type];
-  const auto& production = productions[state.production_index];
-  return state.position_in_production == production.size();
+  return grammar_tables().complete[state.dotted_rule];
 }
 
-bool EarleyParser::is_empty_production(const ParsingState& state) const {
-  const auto& productions = parse_rules[state.nonterminal_type];
-  const auto& production = productions[state.production_index];
-  return production.empty();
+void EarleyParser::add_to_set(ParsingState state, std::size_t chart_index) {
+  if (chart_items[chart_index % 2].insert(state)) {
+    std::uint8_t next = grammar_tables().next_nonterminal[state.dotted_rule];
+    if (next != no_symbol) {
+      chart_waiting[chart_index % 2][next].push_back(static_cast<std::uint32_t>(table[chart_index].size()));
+    }
+    table[chart_index].push_back(state);
+  }
 }
 
-Symbol EarleyParser::next_element(const ParsingState& state) const {
-  const auto& productions = parse_rules[state.nonterminal_type];
-  const auto& production = productions[state.production_index];
-  if (state.position_in_production >= production.size()) throw ParseError("next_element called for finished state");
-  return production[state.position_in_production];
+void EarleyParser::predictor(const ParsingState& state, std::size_t chart_index) {
+  const GrammarTables& grammar = grammar_tables();
+  std::uint8_t next = grammar.next_nonterminal[state.dotted_rule];
+  // Aycock and Horspool: a nullable nonterminal may derive nothing, so the dot moves past it right
+  // away instead of waiting for its empty completion, which the completer then never needs to handle
+  if (grammar.nullable.test(next)) {
+    add_to_set(ParsingState{state.dotted_rule + 1, state.start_token_index}, chart_index);
+  }
+  // a nonterminal's whole prediction closure is added the first time it is predicted in a chart,
+  // so predicting it again, or anything in its closure, adds nothing
+  if (predicted.test(next)) {
+    return;
+  }
+  NonterminalSet added = grammar.prediction_closure[next] & ~predicted;
+  predicted |= added;
+  for (std::size_t nonterminal = 0; nonterminal < added.size(); ++nonterminal) {
+    if (!added.test(nonterminal)) {
+      continue;
+    }
+    for (std::uint32_t i = grammar.initial_begin[nonterminal]; i < grammar.initial_begin[nonterminal + 1]; ++i) {
+      add_to_set(ParsingState{grammar.initial_rules[i], chart_index}, chart_index);
+    }
+  }
 }
 
-bool EarleyParser::is_nonterminal(const Symbol& symbol) const {
-  return std::holds_alternative<Nonterminal>(symbol);
+void EarleyParser::scanner(const ParsingState& state, std::size_t chart_index, const TerminalMask& token_mask) {
+  if (token_mask.test(grammar_tables().next_terminal[state.dotted_rule])) {
+    add_to_set(ParsingState{state.dotted_rule + 1, state.start_token_index}, chart_index + 1);
+  }
 }
 
-bool EarleyParser::is_terminal(const Symbol& symbol) const {
-  return std::holds_alternative<Token>(symbol);
+void EarleyParser::completer(const ParsingState& state, std::size_t chart_index) {
+  // Find all states in S[state.start_token_index] that were waiting for this nonterminal; empty
+  // completions are skipped, since the predictor already moved the dot past nullable nonterminals
+  if (state.start_token_index == chart_index) {
+    return;
+  }
+  std::uint8_t completed = grammar_tables().lhs[state.dotted_rule];
+  // on a deterministic reduction path only its top is added; CompletedItems rebuilds the rest
+  if (const ParsingState* top = leo_top(state.start_token_index, completed)) {
+    add_to_set(*top, chart_index);
+    return;
+  }
+  const WaitingItems& start_chart = waiting[state.start_token_index];
+  for (std::uint32_t i = start_chart.begin[completed]; i < start_chart.begin[completed + 1]; ++i) {
+    add_to_set(start_chart.items[i], chart_index);
+  }
 }
 
-void EarleyParser::add_to_set(ParsingState state, std::size_t chart_index) {
-  auto& chart_set = table[chart_index];
-  if (std::find(chart_set.begin(), chart_set.end(), state) == chart_set.end()) {
-    chart_set.push_back(state);
+void EarleyParser::start() {
+  // Add the initial state: ITEMS → •S (start symbol is ITEMS, rule 0)
+  open_chart();
+  add_to_set(ParsingState::at(Nonterminal::ITEMS, 0, 0, 0), 0);
+}
+
+void EarleyParser::open_chart() {
+  std::size_t chart_index = table.size();
+  table.emplace_back();
+  chart_items[chart_index % 2].clear();
+  for (auto& positions : chart_waiting[chart_index % 2]) {
+    positions.clear();
   }
 }
 
-void EarleyParser::predictor(const ParsingState& state, std::size_t chart_index) {
-  auto next = next_element(state);
-  if (is_nonterminal(next)) {
-    Nonterminal B = std::get<Nonterminal>(next);
-    const auto& productions = parse_rules[static_cast<int>(B)];
-    for (std::size_t i = 0; i < productions.size(); ++i) {
-      ParsingState new_state{
-        static_cast<int>(B),
-        i,
-        0,  // dot at beginning
-        chart_index
-      };
-      add_to_set(new_state, chart_index);
+void EarleyParser::finish_chart(std::size_t chart_index) {
+  const auto& chart_positions = chart_waiting[chart_index % 2];
+  WaitingItems& finished = waiting.emplace_back();
+  std::uint32_t count = 0;
+  for (std::size_t nonterminal = 0; nonterminal < chart_positions.size(); ++nonterminal) {
+    finished.begin[nonterminal] = count;
+    count += static_cast<std::uint32_t>(chart_positions[nonterminal].size());
+  }
+  finished.begin[chart_positions.size()] = count;
+  finished.items.reserve(count);
+  for (const auto& positions : chart_positions) {
+    for (std::uint32_t position : positions) {
+      const ParsingState& state = table[chart_index][position];
+      finished.items.push_back(ParsingState{state.dotted_rule + 1, state.start_token_index});
     }
-  } else {
-    throw ParseError("Predictor - next element is not nonterminal");
   }
-}
 
-void EarleyParser::scanner(const ParsingState& state, std::size_t chart_index) {
-  if (chart_index < tokens.size()) {
-    auto next = next_element(state);
-    const Token& expected_token = std::get<Token>(next);
-    const Token& current_token = tokens[chart_index];
-
-    // Check if the current token matches using Token::match method
-    if (expected_token.match(current_token)) {
-      ParsingState new_state = state;
-      new_state.position_in_production++;
-      add_to_set(new_state, chart_index + 1);
+  // a nonterminal with a single waiting item that completes along with it heads a deterministic
+  // reduction path, whose top is found by following the completed items' origins
+  const GrammarTables& grammar = grammar_tables();
+  for (std::size_t nonterminal = 0; nonterminal < chart_positions.size(); ++nonterminal) {
+    std::uint32_t first = finished.begin[nonterminal];
+    if (finished.begin[nonterminal + 1] - first == 1 && grammar.complete[finished.items[first].dotted_rule]) {
+      finished.leo.emplace_back(static_cast<std::uint8_t>(nonterminal), finished.items[first]);
+    }
+  }
+  // earlier charts' tops are final; a path through this chart's own entries is followed a step at a
+  // time, and a unit-rule cycle stops it after as many steps as there are entries
+  for (auto& [nonterminal, top] : finished.leo) {
+    for (std::size_t steps = 0; steps < finished.leo.size(); ++steps) {
+      const ParsingState* above = leo_top(top.start_token_index, grammar.lhs[top.dotted_rule]);
+      if (above == nullptr) {
+        break;
+      }
+      top = *above;
     }
   }
 }
+const ParsingState* EarleyParser::leo_top(std::size_t chart_index, std::uint8_t nonterminal) const {
+  const auto& leo = waiting[chart_index].leo;
+  auto it = std::lower_bound(leo.begin(), leo.end(), nonterminal,
+                             [](const auto& entry, std::uint8_t value) { return entry.first < value; });
+  return it != leo.end() && it->first == nonterminal ? &it->second : nullptr;
+}
 
-void EarleyParser::completer(const ParsingState& state, std::size_t chart_index) {
-  if (is_finished(state)) {
-    // Find all states in S[state.start_token_index] that were waiting for this nonterminal
-    if (state.start_token_index < table.size()) {
-      const auto& start_chart = table[state.start_token_index];
-      for (const auto& waiting_state : start_chart) {
-        if (!is_finished(waiting_state)) {
-          auto next_symbol = next_element(waiting_state);
-          if (is_nonterminal(next_symbol)) {
-            Nonterminal expected_nonterminal = std::get<Nonterminal>(next_symbol);
-            if (static_cast<int>(expected_nonterminal) == state.nonterminal_type) {
-              ParsingState new_state = waiting_state;
-              new_state.position_in_production++;
-              add_to_set(new_state, chart_index);
-            }
-          }
-        }
-      }
+// token_index is the buffer index of the input token at chart_index, or no_token for the final chart
+void EarleyParser::process_chart(std::size_t chart_index, std::size_t token_index) {
+  const bool token = token_index != no_token;
+  TerminalMask mask;
+  if (token) {
+    open_chart();
+    mask = token_mask(tokens, token_index);
+  }
+  // Process all states in S[k] - states can expand during this loop
+  const GrammarTables& grammar = grammar_tables();
+  predicted.reset();
+  for (std::size_t state_index = 0; state_index < table[chart_index].size(); state_index++) {
+    const ParsingState state = table[chart_index][state_index];
+
+    if (grammar.complete[state.dotted_rule]) {
+      completer(state, chart_index);
+    } else if (grammar.next_nonterminal[state.dotted_rule] != no_symbol) {
+      // also in the final chart, where nothing predicted can be scanned, but nullable
+      // nonterminals still need to be skipped
+      predictor(state, chart_index);
+    } else if (token) {
+      scanner(state, chart_index, mask);
     }
   }
+  finish_chart(chart_index);
 }
 
-EarleyParser::EarleyParser(std::vector<Token>&& input) : tokens{input}, table{tokens.size() + 1} {
-  // Add the initial state: ITEMS → •S (start symbol is ITEMS, rule 0)
-  ParsingState initial_state{
-    static_cast<int>(Nonterminal::ITEMS), // nonterminal_type
-    0,                                    // production_index (first production for ITEMS)
-    0,                                    // position_in_production (dot at beginning)
-    0                                     // start_token_index
-  };
-  add_to_set(initial_state, 0);
+EarleyParser::EarleyParser(TokenBuffer&& input) : tokens{std::move(input)}, tokens_kept{true} {
+  table.reserve(tokens.size() + 1);
+  waiting.reserve(tokens.size() + 1);
+  start();
 
   // Main parsing loop - Earley parser algorithm
-  for (std::size_t k = 0; k <= tokens.size(); ++k) {
-    // Process all states in S[k] - states can expand during this loop
-    for (std::size_t state_index = 0; state_index < table[k].size(); state_index++) {
-      const ParsingState state = *std::next(table[k].begin(), state_index);
-
-      if (is_finished(state)) {
-        completer(state, k);
-      } else if (k < tokens.size()) {
-        auto next = next_element(state);
-        if (is_nonterminal(next)) {
-          predictor(state, k);
-        } else if (is_terminal(next)) {
-          scanner(state, k);
-        }
-      }
+  for (std::size_t k = 0; k < tokens.size(); ++k) {
+    process_chart(k, k);
+  }
+  process_chart(tokens.size(), no_token);
+}
+
+EarleyParser::EarleyParser(Lexer& lexer, bool keep_tokens) : tokens{lexer.source()}, tokens_kept{keep_tokens} {
+  start();
+
+  // Same loop as above, but each token is lexed just before its chart is processed;
+  // without keep_tokens the buffer only ever holds the current token
+  std::size_t k = 0;
+  for (const Token& token : lexer) {
+    if (!keep_tokens) {
+      tokens.clear();
     }
+    tokens.push_back(token);
+    process_chart(k++, tokens.size() - 1);
   }
+  process_chart(k, no_token);
 }
 
 bool EarleyParser::accepts() const {
@@ -191,8 +583,8 @@ bool EarleyParser::accepts() const {
   const auto& final_chart = table.back();
   for (const auto& state : final_chart) {
     // Look for a state that represents a completed ITEMS production
-    if (state.nonterminal_type == static_cast<int>(Nonterminal::ITEMS) &&
-        state.start_token_index == 0 && state.production_index == 0 &&
+    if (state.nonterminal_type() == static_cast<int>(Nonterminal::ITEMS) &&
+        state.start_token_index == 0 && state.production_index() == 0 &&
         is_finished(state)) {
       return true;
     }
@@ -204,15 +596,18 @@ std::unique_ptr<TreeNode> EarleyParser::parse() const {
   if (!accepts()) {
     throw ParseError("Input cannot be parsed");
   }
+  if (!tokens_kept) {
+    throw ParseError("Tokens were not kept, the input can only be recognized");
+  }
 
   // Find the completed ITEMS state in the final chart
   const auto& final_chart = table.back();
   for (const auto& state : final_chart) {
-    if (state.nonterminal_type == static_cast<int>(Nonterminal::ITEMS) &&
-        state.start_token_index == 0 && state.production_index == 0 &&
+    if (state.nonterminal_type() == static_cast<int>(Nonterminal::ITEMS) &&
+        state.start_token_index == 0 && state.production_index() == 0 &&
         is_finished(state)) {
       // Construct the CST using the completed parse state
-      return construct_cst(state, state.start_token_index, tokens.size(), table, tokens, 0);
+      return construct_cst(state, state.start_token_index, tokens.size(), completed_items(), tokens, 0);
     }
   }
   
@@ -220,15 +615,28 @@ std::unique_ptr<TreeNode> EarleyParser::parse() const {
   throw ParseError("Unable to construct CST despite successful parse");
 }
 
+std::size_t EarleyParser::item_count() const {
+  std::size_t count = 0;
+  for (const auto& chart : table) {
+    count += chart.size();
+  }
+  return count;
+}
+
+CompletedItems EarleyParser::completed_items() const {
+  return CompletedItems(table, waiting);
+}
+
 // Helper function to get production length
 std::size_t get_production_length(const ParsingState& state) {
-  const auto& productions = parse_rules[state.nonterminal_type];
-  const auto& production = productions[state.production_index];
+  const auto& productions = parse_rules[state.nonterminal_type()];
+  const auto& production = productions[state.production_index()];
   return production.size();
 }
 
 // Helper function to create tree nodes for terminals
-std::unique_ptr<TreeNode> create_terminal_node(const Token& token) {
+std::unique_ptr<TreeNode> create_terminal_node(const TokenBuffer& tokens, std::size_t index) {
+  Token token = tokens[index];
   switch (token.type) {
     case Token::Type::Identifier: {
       auto node = std::make_unique<IdentifierNode>();
@@ -243,16 +651,21 @@ std::unique_ptr<TreeNode> create_terminal_node(const Token& token) {
     case Token::Type::CharLiteral: {
       auto node = std::make_unique<CharLiteralNode>();
       node->value = token.value;
+      node->decoded = tokens.literal_pool().spelling(tokens.literal(index).string);
   return node;
     }
     case Token::Type::StringLiteral: {
       auto node = std::make_unique<StringLiteralNode>();
       node->value = token.value;
+      node->decoded = tokens.literal_pool().spelling(tokens.literal(index).string);
   return node;
     }
     case Token::Type::IntegerLiteral: {
       auto node = std::make_unique<IntegerLiteralNode>();
       node->value = token.value;
+      node->integer = tokens.literal(index).integer;
+      node->integer_high = tokens.literal(index).integer_high;
+      node->suffix = tokens.literal(index).suffix;
   return node;
     }
     case Token::Type::Punctuation: {
@@ -482,23 +895,23 @@ std::unique_ptr<TreeNode> create_nonterminal_node(Nonterminal nonterminal) {
 
 // Main parsing function that constructs the CST
 std::unique_ptr<TreeNode> construct_cst(const ParsingState& state, std::size_t i, std::size_t j,
-                                         const std::vector<std::vector<ParsingState>>& table,
-                                         const std::vector<Token>& tokens, int depth) {
+                                         const CompletedItems& completed,
+                                         const TokenBuffer& tokens, int depth) {
     if (i > j || depth > 100) return std::make_unique<Unused1Node>();
 
-    const auto& productions = parse_rules[state.nonterminal_type];
-    const auto& production = productions[state.production_index];
+    const auto& productions = parse_rules[state.nonterminal_type()];
+    const auto& production = productions[state.production_index()];
 
     // Handle epsilon productions
     if (production.empty()) {
       // For epsilon productions, return appropriate node based on context
-      if (state.nonterminal_type == static_cast<int>(Nonterminal::OPTIONAL_CONST)) {
+      if (state.nonterminal_type() == static_cast<int>(Nonterminal::OPTIONAL_CONST)) {
         auto node = std::make_unique<OptionalConstNode>();
         node->value = ""; // empty string for epsilon
     return node;
       }
       // For ITEMS epsilon production, return empty ItemsNode
-      if (state.nonterminal_type == static_cast<int>(Nonterminal::ITEMS)) {
+      if (state.nonterminal_type() == static_cast<int>(Nonterminal::ITEMS)) {
         auto node = std::make_unique<ItemsNode>();
         return node;
       }
@@ -507,46 +920,26 @@ std::unique_ptr<TreeNode> construct_cst(const ParsingState& state, std::size_t i
     }
 
     // Create the appropriate node for this nonterminal
-    auto node = create_nonterminal_node(static_cast<Nonterminal>(state.nonterminal_type));
+    auto node = create_nonterminal_node(static_cast<Nonterminal>(state.nonterminal_type()));
 
    // Special handling for ITEMS
-   if (state.nonterminal_type == static_cast<int>(Nonterminal::ITEMS)) {
+   if (state.nonterminal_type() == static_cast<int>(Nonterminal::ITEMS)) {
      auto items_node = static_cast<ItemsNode*>(node.get());
 
-     if (state.production_index == 0) { // ITEMS -> ITEMS ITEM
+     if (state.production_index() == 0) { // ITEMS -> ITEMS ITEM
        // Find the split point k where ITEMS ends at k and ITEM starts at k
        for (std::size_t k = i; k <= j; ++k) {
-         bool has_items = (k == i); // epsilon ITEMS
-         if (k > i && k < table.size()) {
-           has_items = std::any_of(table[k].begin(), table[k].end(), [&](const ParsingState& s) {
-             return s.nonterminal_type == static_cast<int>(Nonterminal::ITEMS) &&
-                    s.start_token_index == i && is_finished_state(s, parse_rules);
-           });
-         }
-         bool has_item = (k <= j && j < table.size()) ? std::any_of(table[j].begin(), table[j].end(), [&](const ParsingState& s) {
-           return s.nonterminal_type == static_cast<int>(Nonterminal::ITEM) &&
-                  s.start_token_index == k && is_finished_state(s, parse_rules);
-         }) : false;
+         std::optional<ParsingState> items_state = completed.in_chart(Nonterminal::ITEMS, i, k);
+         bool has_items = (k == i) || items_state; // epsilon ITEMS
+         std::optional<ParsingState> item_state = completed.in_chart(Nonterminal::ITEM, k, j);
 
-         if (has_items && has_item) {
-           if (k > i) {
+         if (has_items && item_state) {
+           if (k > i && items_state) {
              // Add the ITEMS child
-             auto items_it = std::find_if(table[k].begin(), table[k].end(), [&](const ParsingState& s) {
-               return s.nonterminal_type == static_cast<int>(Nonterminal::ITEMS) &&
-                      s.start_token_index == i && is_finished_state(s, parse_rules);
-             });
-             if (items_it != table[k].end()) {
-               items_node->items.push_back(construct_cst(*items_it, i, k, table, tokens, depth + 1));
-             }
+             items_node->items.push_back(construct_cst(*items_state, i, k, completed, tokens, depth + 1));
            }
            // Add the ITEM child
-           auto item_it = std::find_if(table[j].begin(), table[j].end(), [&](const ParsingState& s) {
-             return s.nonterminal_type == static_cast<int>(Nonterminal::ITEM) &&
-                    s.start_token_index == k && is_finished_state(s, parse_rules);
-           });
-           if (item_it != table[j].end()) {
-             items_node->items.push_back(construct_cst(*item_it, k, j, table, tokens, depth + 1));
-           }
+           items_node->items.push_back(construct_cst(*item_state, k, j, completed, tokens, depth + 1));
            break;
          }
        }
@@ -565,7 +958,7 @@ std::unique_ptr<TreeNode> construct_cst(const ParsingState& state, std::size_t i
        const Token& expected_token = std::get<Token>(symbol);
        if (token_pos < tokens.size() && expected_token.match(tokens[token_pos])) {
          // Create terminal node and add to children
-         auto terminal_node = create_terminal_node(tokens[token_pos]);
+         auto terminal_node = create_terminal_node(tokens, token_pos);
          node->children.push_back(std::move(terminal_node));
          token_pos++;
        }
@@ -574,24 +967,14 @@ std::unique_ptr<TreeNode> construct_cst(const ParsingState& state, std::size_t i
        // Nonterminal symbol - find the child state and recursively construct
        Nonterminal child_nonterminal = std::get<Nonterminal>(symbol);
 
-       // Find finished state for this nonterminal starting at token_pos
-       std::optional<std::pair<ParsingState, std::size_t>> found;
-       for (int chart_k = j; chart_k >= (int)token_pos; --chart_k) {
-         if ((std::size_t)chart_k >= table.size()) continue;
-         const auto& chart = table[chart_k];
-         for (const auto& child_state : chart) {
-           if (child_state.nonterminal_type == static_cast<int>(child_nonterminal) &&
-               child_state.start_token_index == token_pos &&
-               is_finished_state(child_state, parse_rules)) {
-             if (!found || (std::size_t)chart_k > found->second) {
-               found = {child_state, (std::size_t)chart_k};
-             }
-           }
-         }
+       // Find the finished state for this nonterminal starting at token_pos that ends latest
+       CompletedItems::Found found;
+       if (token_pos <= j) {
+         found = completed.latest(child_nonterminal, token_pos, j);
        }
        if (found) {
          auto [child_state, chart_k] = *found;
-         auto child_node = construct_cst(child_state, token_pos, chart_k, table, tokens, depth + 1);
+         auto child_node = construct_cst(child_state, token_pos, chart_k, completed, tokens, depth + 1);
          node->children.push_back(std::move(child_node));
          token_pos = chart_k;
        } else {
@@ -602,14 +985,14 @@ std::unique_ptr<TreeNode> construct_cst(const ParsingState& state, std::size_t i
    }
 
    // Set specific fields for nodes that have specific child fields
-   if (state.nonterminal_type == static_cast<int>(Nonterminal::ITEM)) {
+   if (state.nonterminal_type() == static_cast<int>(Nonterminal::ITEM)) {
      auto item_node = static_cast<ItemNode*>(node.get());
      if (!node->children.empty()) {
        item_node->item = node->children[0].get();
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::FUNCTION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::FUNCTION)) {
      auto fn_node = static_cast<FunctionNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 8) {
+     if (state.production_index() == 0 && node->children.size() >= 8) {
        fn_node->optional_const = node->children[0].get();
        // children[1] is "fn", children[2] is Identifier
        fn_node->identifier = static_cast<IdentifierNode*>(node->children[2].get())->value;
@@ -621,53 +1004,53 @@ std::unique_ptr<TreeNode> construct_cst(const ParsingState& state, std::size_t i
        fn_node->block_expression_or_semicolon = node->children[7].get();
      }
      // node->children.clear(); // don't clear to keep ownership
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::FUNCTION_PARAMETERS)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::FUNCTION_PARAMETERS)) {
      auto fp_node = static_cast<FunctionParametersNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        fp_node->self_param = node->children[0].get();
        fp_node->optional_comma = node->children[1].get();
-     } else if (state.production_index == 1) {
+     } else if (state.production_index() == 1) {
        fp_node->function_params.push_back(node->children[0].get());
        fp_node->comma_function_params = node->children[1].get();
        fp_node->optional_comma = node->children[2].get();
-     } else if (state.production_index == 2) {
+     } else if (state.production_index() == 2) {
        fp_node->self_param = node->children[0].get();
        fp_node->function_params.push_back(node->children[2].get());
        fp_node->comma_function_params = node->children[3].get();
        fp_node->optional_comma = node->children[4].get();
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::OPTIONAL_CONST)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::OPTIONAL_CONST)) {
      auto oc_node = static_cast<OptionalConstNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        oc_node->value = "const";
      } else {
        oc_node->value = "";
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::SELF_PARAM)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::SELF_PARAM)) {
      auto sp_node = static_cast<SelfParamNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        sp_node->shorthand_self = node->children[0].get();
      } else {
        sp_node->typed_self = node->children[0].get();
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::SHORTHAND_SELF)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::SHORTHAND_SELF)) {
      auto ss_node = static_cast<ShorthandSelfNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        ss_node->ampersand = "&";
        ss_node->mut = "mut";
        ss_node->self = "self";
-     } else if (state.production_index == 1) {
+     } else if (state.production_index() == 1) {
        ss_node->ampersand = "&";
        ss_node->self = "self";
-     } else if (state.production_index == 2) {
+     } else if (state.production_index() == 2) {
        ss_node->mut = "mut";
        ss_node->self = "self";
      } else {
        ss_node->self = "self";
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::TYPED_SELF)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::TYPED_SELF)) {
      auto ts_node = static_cast<TypedSelfNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        ts_node->mut = "mut";
        ts_node->self = "self";
        ts_node->type = std::move(node->children[3]);
@@ -675,56 +1058,56 @@ std::unique_ptr<TreeNode> construct_cst(const ParsingState& state, std::size_t i
        ts_node->self = "self";
        ts_node->type = std::move(node->children[2]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::FUNCTION_PARAM)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::FUNCTION_PARAM)) {
      auto fparam_node = static_cast<FunctionParamNode*>(node.get());
      fparam_node->pattern = std::move(node->children[0]);
      fparam_node->type = std::move(node->children[2]);
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::FUNCTION_RETURN_TYPE)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::FUNCTION_RETURN_TYPE)) {
      auto frt_node = static_cast<FunctionReturnTypeNode*>(node.get());
      frt_node->type = std::move(node->children[1]);
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::OPTIONAL_FUNCTION_PARAMETERS)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::OPTIONAL_FUNCTION_PARAMETERS)) {
      auto ofp_node = static_cast<OptionalFunctionParametersNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        ofp_node->function_parameters = std::move(node->children[0]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::OPTIONAL_FUNCTION_RETURN_TYPE)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::OPTIONAL_FUNCTION_RETURN_TYPE)) {
      auto ofrt_node = static_cast<OptionalFunctionReturnTypeNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        ofrt_node->function_return_type = std::move(node->children[0]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::OPTIONAL_COMMA)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::OPTIONAL_COMMA)) {
      auto oc_node = static_cast<OptionalCommaNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        oc_node->value = ",";
      } else {
        oc_node->value = "";
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::COMMA_FUNCTION_PARAMS)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::COMMA_FUNCTION_PARAMS)) {
      auto cfp_node = static_cast<CommaFunctionParamsNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        auto prev = static_cast<CommaFunctionParamsNode*>(node->children[0].get());
        cfp_node->function_params = prev->function_params;
        cfp_node->function_params.push_back(node->children[2].get());
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::BLOCK_EXPRESSION_OR_SEMICOLON)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::BLOCK_EXPRESSION_OR_SEMICOLON)) {
      auto beos_node = static_cast<BlockExpressionOrSemicolonNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        beos_node->block_expression = std::move(node->children[0]);
        beos_node->semicolon = "";
      } else {
        beos_node->semicolon = static_cast<PunctuationNode*>(node->children[0].get())->value;
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::BLOCK_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::BLOCK_EXPRESSION)) {
      auto be_node = static_cast<BlockExpressionNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 4) {
+     if (state.production_index() == 0 && node->children.size() >= 4) {
        be_node->statements = node->children[1].get();
        be_node->expression = node->children[2].get();
-     } else if (state.production_index == 1 && node->children.size() >= 3) {
+     } else if (state.production_index() == 1 && node->children.size() >= 3) {
        be_node->statements = node->children[1].get();
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::STATEMENTS)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::STATEMENTS)) {
      auto st_node = static_cast<StatementsNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        if (node->children.size() >= 3) {
          auto prev_st = static_cast<StatementsNode*>(node->children[0].get());
          st_node->statements = prev_st->statements;
@@ -733,631 +1116,631 @@ std::unique_ptr<TreeNode> construct_cst(const ParsingState& state, std::size_t i
          st_node->statements.push_back(node->children[0].get());
        }
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::EXPRESSION)) {
      auto expr_node = static_cast<ExpressionNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        expr_node->flow_control_expression = std::move(node->children[0]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::FLOW_CONTROL_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::FLOW_CONTROL_EXPRESSION)) {
      auto fce_node = static_cast<FlowControlExpressionNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        fce_node->assignment_expression = std::move(node->children[0]);
-     } else if (state.production_index == 1) {
+     } else if (state.production_index() == 1) {
        fce_node->continue_expression = std::move(node->children[0]);
-     } else if (state.production_index == 2) {
+     } else if (state.production_index() == 2) {
        fce_node->break_expression = std::move(node->children[0]);
-     } else if (state.production_index == 3) {
+     } else if (state.production_index() == 3) {
        fce_node->return_expression = std::move(node->children[0]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::ASSIGNMENT_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::ASSIGNMENT_EXPRESSION)) {
      auto ae_node = static_cast<AssignmentExpressionNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        ae_node->lazy_or_expression = std::move(node->children[0]);
-     } else if (state.production_index == 1) {
+     } else if (state.production_index() == 1) {
        ae_node->simple_assignment_expression = std::move(node->children[0]);
-     } else if (state.production_index == 2) {
+     } else if (state.production_index() == 2) {
        ae_node->compound_assignment_expression = std::move(node->children[0]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::SIMPLE_ASSIGNMENT_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::SIMPLE_ASSIGNMENT_EXPRESSION)) {
      auto sae_node = static_cast<SimpleAssignmentExpressionNode*>(node.get());
      sae_node->lazy_or_expression = std::move(node->children[0]);
      sae_node->assignment_expression = std::move(node->children[2]);
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::COMPOUND_ASSIGNMENT_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::COMPOUND_ASSIGNMENT_EXPRESSION)) {
      auto cae_node = static_cast<CompoundAssignmentExpressionNode*>(node.get());
      cae_node->lazy_or_expression = std::move(node->children[0]);
      cae_node->operator_ = static_cast<PunctuationNode*>(node->children[1].get())->value;
      cae_node->assignment_expression = std::move(node->children[2]);
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::LAZY_OR_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::LAZY_OR_EXPRESSION)) {
      auto lor_node = static_cast<LazyOrExpressionNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        lor_node->lazy_and_expression = std::move(node->children[0]);
-     } else if (state.production_index == 1 && node->children.size() >= 3) {
+     } else if (state.production_index() == 1 && node->children.size() >= 3) {
        lor_node->lazy_and_expression = std::move(node->children[0]);
        lor_node->lazy_or_expression = std::move(node->children[2]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::LAZY_AND_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::LAZY_AND_EXPRESSION)) {
      auto land_node = static_cast<LazyAndExpressionNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        land_node->comparison_operator_expression = std::move(node->children[0]);
-     } else if (state.production_index == 1 && node->children.size() >= 3) {
+     } else if (state.production_index() == 1 && node->children.size() >= 3) {
        land_node->comparison_operator_expression = std::move(node->children[0]);
        land_node->lazy_and_expression = std::move(node->children[2]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::COMPARISON_OPERATOR_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::COMPARISON_OPERATOR_EXPRESSION)) {
      auto coe_node = static_cast<ComparisonOperatorExpressionNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        coe_node->or_expression = std::move(node->children[0]);
-     } else if (state.production_index >= 1 && node->children.size() >= 3) {
+     } else if (state.production_index() >= 1 && node->children.size() >= 3) {
        coe_node->or_expression = std::move(node->children[0]);
        coe_node->operator_ = static_cast<PunctuationNode*>(node->children[1].get())->value;
        coe_node->or_expression_right = std::move(node->children[2]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::OR_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::OR_EXPRESSION)) {
      auto or_node = static_cast<OrExpressionNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        or_node->xor_expression = std::move(node->children[0]);
-     } else if (state.production_index == 1 && node->children.size() >= 3) {
+     } else if (state.production_index() == 1 && node->children.size() >= 3) {
        or_node->xor_expression = std::move(node->children[0]);
        or_node->or_expression = std::move(node->children[2]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::XOR_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::XOR_EXPRESSION)) {
      auto xor_node = static_cast<XorExpressionNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        xor_node->and_expression = std::move(node->children[0]);
-     } else if (state.production_index == 1 && node->children.size() >= 3) {
+     } else if (state.production_index() == 1 && node->children.size() >= 3) {
        xor_node->and_expression = std::move(node->children[0]);
        xor_node->xor_expression = std::move(node->children[2]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::AND_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::AND_EXPRESSION)) {
      auto and_node = static_cast<AndExpressionNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        and_node->shift_operator_expression = std::move(node->children[0]);
-     } else if (state.production_index == 1 && node->children.size() >= 3) {
+     } else if (state.production_index() == 1 && node->children.size() >= 3) {
        and_node->shift_operator_expression = std::move(node->children[0]);
        and_node->and_expression = std::move(node->children[2]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::SHIFT_OPERATOR_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::SHIFT_OPERATOR_EXPRESSION)) {
      auto soe_node = static_cast<ShiftOperatorExpressionNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        soe_node->additive_operator_expression = std::move(node->children[0]);
-     } else if (state.production_index >= 1 && node->children.size() >= 3) {
+     } else if (state.production_index() >= 1 && node->children.size() >= 3) {
        soe_node->additive_operator_expression = std::move(node->children[0]);
        soe_node->operator_ = static_cast<PunctuationNode*>(node->children[1].get())->value;
        soe_node->shift_operator_expression = std::move(node->children[2]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::ADDITIVE_OPERATOR_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::ADDITIVE_OPERATOR_EXPRESSION)) {
      auto aoe_node = static_cast<AdditiveOperatorExpressionNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        aoe_node->multiplicative_operator_expression = std::move(node->children[0]);
-     } else if (state.production_index >= 1 && node->children.size() >= 3) {
+     } else if (state.production_index() >= 1 && node->children.size() >= 3) {
        aoe_node->multiplicative_operator_expression = std::move(node->children[0]);
        aoe_node->operator_ = static_cast<PunctuationNode*>(node->children[1].get())->value;
        aoe_node->additive_operator_expression = std::move(node->children[2]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::MULTIPLICATIVE_OPERATOR_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::MULTIPLICATIVE_OPERATOR_EXPRESSION)) {
      auto moe_node = static_cast<MultiplicativeOperatorExpressionNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        moe_node->type_cast_expression = std::move(node->children[0]);
-     } else if (state.production_index >= 1 && node->children.size() >= 3) {
+     } else if (state.production_index() >= 1 && node->children.size() >= 3) {
        moe_node->type_cast_expression = std::move(node->children[0]);
        moe_node->operator_ = static_cast<PunctuationNode*>(node->children[1].get())->value;
        moe_node->multiplicative_operator_expression = std::move(node->children[2]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::TYPE_CAST_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::TYPE_CAST_EXPRESSION)) {
      auto tce_node = static_cast<TypeCastExpressionNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        tce_node->unary_operator_expression = std::move(node->children[0]);
-     } else if (state.production_index == 1 && node->children.size() >= 3) {
+     } else if (state.production_index() == 1 && node->children.size() >= 3) {
        tce_node->unary_operator_expression = std::move(node->children[0]);
        tce_node->type_cast_expression = std::move(node->children[1]);
        tce_node->type = std::move(node->children[2]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::UNARY_OPERATOR_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::UNARY_OPERATOR_EXPRESSION)) {
      auto uoe_node = static_cast<UnaryOperatorExpressionNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        uoe_node->postfix_expression = std::move(node->children[0]);
-     } else if (state.production_index == 1) {
+     } else if (state.production_index() == 1) {
        uoe_node->borrow_expression = std::move(node->children[0]);
-     } else if (state.production_index == 2) {
+     } else if (state.production_index() == 2) {
        uoe_node->dereference_expression = std::move(node->children[0]);
-     } else if (state.production_index == 3) {
+     } else if (state.production_index() == 3) {
        uoe_node->negation_expression = std::move(node->children[0]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::POSTFIX_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::POSTFIX_EXPRESSION)) {
      auto pe_node = static_cast<PostfixExpressionNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        pe_node->basic_expression = std::move(node->children[0]);
-     } else if (state.production_index == 1) {
+     } else if (state.production_index() == 1) {
        pe_node->method_call_expression = std::move(node->children[0]);
-     } else if (state.production_index == 2) {
+     } else if (state.production_index() == 2) {
        pe_node->field_expression = std::move(node->children[0]);
-     } else if (state.production_index == 3) {
+     } else if (state.production_index() == 3) {
        pe_node->call_expression = std::move(node->children[0]);
-     } else if (state.production_index == 4) {
+     } else if (state.production_index() == 4) {
        pe_node->index_expression = std::move(node->children[0]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::BASIC_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::BASIC_EXPRESSION)) {
      auto be_node = static_cast<BasicExpressionNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        be_node->literal_expression = std::move(node->children[0]);
-     } else if (state.production_index == 1) {
+     } else if (state.production_index() == 1) {
        be_node->underscore_expression = std::move(node->children[0]);
-     } else if (state.production_index == 2) {
+     } else if (state.production_index() == 2) {
        be_node->grouped_expression = std::move(node->children[0]);
-     } else if (state.production_index == 3) {
+     } else if (state.production_index() == 3) {
        be_node->array_expression = std::move(node->children[0]);
-     } else if (state.production_index == 4) {
+     } else if (state.production_index() == 4) {
        be_node->path_expression = std::move(node->children[0]);
-     } else if (state.production_index == 5) {
+     } else if (state.production_index() == 5) {
        be_node->struct_expression = std::move(node->children[0]);
-     } else if (state.production_index == 6) {
+     } else if (state.production_index() == 6) {
        be_node->expression_with_block = std::move(node->children[0]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::LITERAL_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::LITERAL_EXPRESSION)) {
      auto le_node = static_cast<LiteralExpressionNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        le_node->char_literal = std::move(node->children[0]);
-     } else if (state.production_index == 1) {
+     } else if (state.production_index() == 1) {
        le_node->string_literal = std::move(node->children[0]);
-     } else if (state.production_index == 2) {
+     } else if (state.production_index() == 2) {
        le_node->integer_literal = std::move(node->children[0]);
-     } else if (state.production_index == 3) {
+     } else if (state.production_index() == 3) {
        le_node->true_keyword = "true";
-     } else if (state.production_index == 4) {
+     } else if (state.production_index() == 4) {
        le_node->false_keyword = "false";
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::PATH_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::PATH_EXPRESSION)) {
      auto pe_node = static_cast<PathExpressionNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        pe_node->path_in_expression = std::move(node->children[0]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::UNIT_TYPE)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::UNIT_TYPE)) {
      // UnitTypeNode has no fields
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::PATH_IN_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::PATH_IN_EXPRESSION)) {
      auto pie_node = static_cast<PathInExpressionNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        pie_node->path_expr_segment = std::move(node->children[0]);
-     } else if (state.production_index == 1 && node->children.size() >= 3) {
+     } else if (state.production_index() == 1 && node->children.size() >= 3) {
        pie_node->path_expr_segment = std::move(node->children[0]);
        pie_node->path_expr_segment2 = std::move(node->children[2]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::PATH_EXPR_SEGMENT)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::PATH_EXPR_SEGMENT)) {
      auto pes_node = static_cast<PathExprSegmentNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        pes_node->identifier = static_cast<IdentifierNode*>(node->children[0].get())->value;
-     } else if (state.production_index == 1) {
+     } else if (state.production_index() == 1) {
        pes_node->self_keyword = "Self";
-     } else if (state.production_index == 2) {
+     } else if (state.production_index() == 2) {
        pes_node->self_keyword = "self";
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::CALL_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::CALL_EXPRESSION)) {
      auto ce_node = static_cast<CallExpressionNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 3) {
+     if (state.production_index() == 0 && node->children.size() >= 3) {
        ce_node->postfix_expression = std::move(node->children[0]);
        ce_node->optional_call_params = std::move(node->children[2]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::OPTIONAL_CALL_PARAMS)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::OPTIONAL_CALL_PARAMS)) {
      auto ocp_node = static_cast<OptionalCallParamsNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        ocp_node->call_params = std::move(node->children[0]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::CALL_PARAMS)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::CALL_PARAMS)) {
      auto cp_node = static_cast<CallParamsNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 3) {
+     if (state.production_index() == 0 && node->children.size() >= 3) {
        cp_node->expressions.push_back(std::move(node->children[0]));
        auto ccp = static_cast<CommaCallParamsNode*>(node->children[1].get());
        cp_node->expressions.insert(cp_node->expressions.end(), std::make_move_iterator(ccp->expressions.begin()), std::make_move_iterator(ccp->expressions.end()));
        cp_node->optional_comma = std::move(node->children[2]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::COMMA_CALL_PARAMS)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::COMMA_CALL_PARAMS)) {
      auto ccp_node = static_cast<CommaCallParamsNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 3) {
+     if (state.production_index() == 0 && node->children.size() >= 3) {
        auto prev_ccp = static_cast<CommaCallParamsNode*>(node->children[0].get());
        ccp_node->expressions = std::move(prev_ccp->expressions);
        ccp_node->expressions.push_back(std::move(node->children[2]));
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::NEGATION_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::NEGATION_EXPRESSION)) {
      auto ne_node = static_cast<NegationExpressionNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 2) {
+     if (state.production_index() == 0 && node->children.size() >= 2) {
        ne_node->operator_ = static_cast<PunctuationNode*>(node->children[0].get())->value;
        ne_node->unary_operator_expression = std::move(node->children[1]);
-     } else if (state.production_index == 1 && node->children.size() >= 2) {
+     } else if (state.production_index() == 1 && node->children.size() >= 2) {
        ne_node->operator_ = static_cast<PunctuationNode*>(node->children[0].get())->value;
        ne_node->unary_operator_expression = std::move(node->children[1]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::STRUCT)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::STRUCT)) {
      auto struct_node = static_cast<StructNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 5) {
+     if (state.production_index() == 0 && node->children.size() >= 5) {
        struct_node->identifier = static_cast<IdentifierNode*>(node->children[1].get())->value;
        struct_node->optional_struct_fields = std::move(node->children[3]);
-     } else if (state.production_index == 1 && node->children.size() >= 3) {
+     } else if (state.production_index() == 1 && node->children.size() >= 3) {
        struct_node->identifier = static_cast<IdentifierNode*>(node->children[1].get())->value;
        struct_node->semicolon = ";";
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::STRUCT_FIELDS)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::STRUCT_FIELDS)) {
      auto sf_node = static_cast<StructFieldsNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 3) {
+     if (state.production_index() == 0 && node->children.size() >= 3) {
        sf_node->struct_fields.push_back(std::move(node->children[0]));
        auto csf = static_cast<CommaStructFieldsNode*>(node->children[1].get());
        sf_node->struct_fields.insert(sf_node->struct_fields.end(), std::make_move_iterator(csf->struct_fields.begin()), std::make_move_iterator(csf->struct_fields.end()));
        sf_node->optional_comma = std::move(node->children[2]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::STRUCT_FIELD)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::STRUCT_FIELD)) {
      auto sf_node = static_cast<StructFieldNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 3) {
+     if (state.production_index() == 0 && node->children.size() >= 3) {
        sf_node->identifier = static_cast<IdentifierNode*>(node->children[0].get())->value;
        sf_node->type = std::move(node->children[2]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::OPTIONAL_STRUCT_FIELDS)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::OPTIONAL_STRUCT_FIELDS)) {
      auto osf_node = static_cast<OptionalStructFieldsNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        osf_node->struct_fields = std::move(node->children[0]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::COMMA_STRUCT_FIELDS)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::COMMA_STRUCT_FIELDS)) {
      auto csf_node = static_cast<CommaStructFieldsNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 3) {
+     if (state.production_index() == 0 && node->children.size() >= 3) {
        auto prev_csf = static_cast<CommaStructFieldsNode*>(node->children[0].get());
        csf_node->struct_fields = std::move(prev_csf->struct_fields);
        csf_node->struct_fields.push_back(std::move(node->children[2]));
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::ENUMERATION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::ENUMERATION)) {
      auto enum_node = static_cast<EnumerationNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 4) {
+     if (state.production_index() == 0 && node->children.size() >= 4) {
        enum_node->identifier = static_cast<IdentifierNode*>(node->children[1].get())->value;
        enum_node->optional_enum_variants = std::move(node->children[3]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::ENUM_VARIANTS)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::ENUM_VARIANTS)) {
      auto ev_node = static_cast<EnumVariantsNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 3) {
+     if (state.production_index() == 0 && node->children.size() >= 3) {
        ev_node->enum_variants.push_back(std::move(node->children[0]));
        auto cev = static_cast<CommaEnumVariantsNode*>(node->children[1].get());
        ev_node->enum_variants.insert(ev_node->enum_variants.end(), std::make_move_iterator(cev->enum_variants.begin()), std::make_move_iterator(cev->enum_variants.end()));
        ev_node->optional_comma = std::move(node->children[2]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::ENUM_VARIANT)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::ENUM_VARIANT)) {
      auto ev_node = static_cast<EnumVariantNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        ev_node->identifier = static_cast<IdentifierNode*>(node->children[0].get())->value;
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::OPTIONAL_ENUM_VARIANTS)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::OPTIONAL_ENUM_VARIANTS)) {
      auto oev_node = static_cast<OptionalEnumVariantsNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        oev_node->enum_variants = std::move(node->children[0]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::COMMA_ENUM_VARIANTS)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::COMMA_ENUM_VARIANTS)) {
      auto cev_node = static_cast<CommaEnumVariantsNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 3) {
+     if (state.production_index() == 0 && node->children.size() >= 3) {
        auto prev_cev = static_cast<CommaEnumVariantsNode*>(node->children[0].get());
        cev_node->enum_variants = std::move(prev_cev->enum_variants);
        cev_node->enum_variants.push_back(std::move(node->children[2]));
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::CONSTANT_ITEM)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::CONSTANT_ITEM)) {
      auto ci_node = static_cast<ConstantItemNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 6) {
+     if (state.production_index() == 0 && node->children.size() >= 6) {
        ci_node->identifier = static_cast<IdentifierNode*>(node->children[1].get())->value;
        ci_node->type = std::move(node->children[3]);
        ci_node->expression = std::move(node->children[5]);
-     } else if (state.production_index == 1 && node->children.size() >= 5) {
+     } else if (state.production_index() == 1 && node->children.size() >= 5) {
        ci_node->identifier = static_cast<IdentifierNode*>(node->children[1].get())->value;
        ci_node->type = std::move(node->children[3]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::TRAIT)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::TRAIT)) {
      auto trait_node = static_cast<TraitNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 4) {
+     if (state.production_index() == 0 && node->children.size() >= 4) {
        trait_node->identifier = static_cast<IdentifierNode*>(node->children[1].get())->value;
        trait_node->items = std::move(node->children[3]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::IMPLEMENTATION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::IMPLEMENTATION)) {
      auto impl_node = static_cast<ImplementationNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        impl_node->inherent_impl = std::move(node->children[0]);
      } else {
        impl_node->trait_impl = std::move(node->children[0]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::INHERENT_IMPL)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::INHERENT_IMPL)) {
      auto ii_node = static_cast<InherentImplNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 4) {
+     if (state.production_index() == 0 && node->children.size() >= 4) {
        ii_node->type = std::move(node->children[1]);
        ii_node->items = std::move(node->children[3]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::TRAIT_IMPL)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::TRAIT_IMPL)) {
      auto ti_node = static_cast<TraitImplNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 6) {
+     if (state.production_index() == 0 && node->children.size() >= 6) {
        ti_node->identifier = static_cast<IdentifierNode*>(node->children[1].get())->value;
        ti_node->type = std::move(node->children[3]);
        ti_node->items = std::move(node->children[5]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::STATEMENT)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::STATEMENT)) {
      auto stmt_node = static_cast<StatementNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        stmt_node->semicolon = ";";
-     } else if (state.production_index == 1) {
+     } else if (state.production_index() == 1) {
        stmt_node->item = std::move(node->children[0]);
-     } else if (state.production_index == 2) {
+     } else if (state.production_index() == 2) {
        stmt_node->let_statement = std::move(node->children[0]);
-     } else if (state.production_index == 3) {
+     } else if (state.production_index() == 3) {
        stmt_node->expression_statement = std::move(node->children[0]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::LET_STATEMENT)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::LET_STATEMENT)) {
      auto ls_node = static_cast<LetStatementNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 6) {
+     if (state.production_index() == 0 && node->children.size() >= 6) {
        ls_node->pattern = std::move(node->children[1]);
        ls_node->type = std::move(node->children[3]);
        ls_node->expression = std::move(node->children[5]);
-     } else if (state.production_index == 1 && node->children.size() >= 5) {
+     } else if (state.production_index() == 1 && node->children.size() >= 5) {
        ls_node->pattern = std::move(node->children[1]);
        ls_node->type = std::move(node->children[3]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::EXPRESSION_STATEMENT)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::EXPRESSION_STATEMENT)) {
      auto es_node = static_cast<ExpressionStatementNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 2) {
+     if (state.production_index() == 0 && node->children.size() >= 2) {
        es_node->expression = std::move(node->children[0]);
-     } else if (state.production_index == 1) {
+     } else if (state.production_index() == 1) {
        es_node->expression_with_block = std::move(node->children[0]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::UNDERSCORE_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::UNDERSCORE_EXPRESSION)) {
      auto ue_node = static_cast<UnderscoreExpressionNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        ue_node->value = "_";
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::GROUPED_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::GROUPED_EXPRESSION)) {
      auto ge_node = static_cast<GroupedExpressionNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 3) {
+     if (state.production_index() == 0 && node->children.size() >= 3) {
        ge_node->expression = std::move(node->children[1]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::ARRAY_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::ARRAY_EXPRESSION)) {
      auto ae_node = static_cast<ArrayExpressionNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 3) {
+     if (state.production_index() == 0 && node->children.size() >= 3) {
        ae_node->optional_array_elements = std::move(node->children[1]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::OPTIONAL_ARRAY_ELEMENTS)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::OPTIONAL_ARRAY_ELEMENTS)) {
      auto oae_node = static_cast<OptionalArrayElementsNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        oae_node->array_elements = std::move(node->children[0]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::ARRAY_ELEMENTS)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::ARRAY_ELEMENTS)) {
      auto ae_node = static_cast<ArrayElementsNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 4) {
+     if (state.production_index() == 0 && node->children.size() >= 4) {
        ae_node->expressions.push_back(std::move(node->children[0]));
        auto cae = static_cast<CommaArrayElementsNode*>(node->children[1].get());
        ae_node->expressions.insert(ae_node->expressions.end(), std::make_move_iterator(cae->expressions.begin()), std::make_move_iterator(cae->expressions.end()));
        ae_node->optional_comma = std::move(node->children[2]);
-     } else if (state.production_index == 1 && node->children.size() >= 3) {
+     } else if (state.production_index() == 1 && node->children.size() >= 3) {
        ae_node->expression = std::move(node->children[0]);
        ae_node->size_expression = std::move(node->children[2]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::COMMA_ARRAY_ELEMENTS)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::COMMA_ARRAY_ELEMENTS)) {
      auto cae_node = static_cast<CommaArrayElementsNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 3) {
+     if (state.production_index() == 0 && node->children.size() >= 3) {
        auto prev_cae = static_cast<CommaArrayElementsNode*>(node->children[0].get());
        cae_node->expressions = std::move(prev_cae->expressions);
        cae_node->expressions.push_back(std::move(node->children[2]));
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::STRUCT_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::STRUCT_EXPRESSION)) {
      auto se_node = static_cast<StructExpressionNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 4) {
+     if (state.production_index() == 0 && node->children.size() >= 4) {
        se_node->path_in_expression = std::move(node->children[0]);
        se_node->optional_struct_expr_fields = std::move(node->children[2]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::OPTIONAL_STRUCT_EXPR_FIELDS)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::OPTIONAL_STRUCT_EXPR_FIELDS)) {
      auto osef_node = static_cast<OptionalStructExprFieldsNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        osef_node->struct_expr_fields = std::move(node->children[0]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::STRUCT_EXPR_FIELDS)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::STRUCT_EXPR_FIELDS)) {
      auto sef_node = static_cast<StructExprFieldsNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 3) {
+     if (state.production_index() == 0 && node->children.size() >= 3) {
        sef_node->struct_expr_fields.push_back(std::move(node->children[0]));
        auto csef = static_cast<CommaStructExprFieldsNode*>(node->children[1].get());
        sef_node->struct_expr_fields.insert(sef_node->struct_expr_fields.end(), std::make_move_iterator(csef->struct_expr_fields.begin()), std::make_move_iterator(csef->struct_expr_fields.end()));
        sef_node->optional_comma = std::move(node->children[2]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::COMMA_STRUCT_EXPR_FIELDS)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::COMMA_STRUCT_EXPR_FIELDS)) {
      auto csef_node = static_cast<CommaStructExprFieldsNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 3) {
+     if (state.production_index() == 0 && node->children.size() >= 3) {
        auto prev_csef = static_cast<CommaStructExprFieldsNode*>(node->children[0].get());
        csef_node->struct_expr_fields = std::move(prev_csef->struct_expr_fields);
        csef_node->struct_expr_fields.push_back(std::move(node->children[2]));
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::STRUCT_EXPR_FIELD)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::STRUCT_EXPR_FIELD)) {
      auto sef_node = static_cast<StructExprFieldNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 3) {
+     if (state.production_index() == 0 && node->children.size() >= 3) {
        sef_node->identifier = static_cast<IdentifierNode*>(node->children[0].get())->value;
        sef_node->expression = std::move(node->children[2]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::METHOD_CALL_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::METHOD_CALL_EXPRESSION)) {
      auto mce_node = static_cast<MethodCallExpressionNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 5) {
+     if (state.production_index() == 0 && node->children.size() >= 5) {
        mce_node->postfix_expression = std::move(node->children[0]);
        mce_node->path_expr_segment = std::move(node->children[2]);
        mce_node->optional_call_params = std::move(node->children[4]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::FIELD_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::FIELD_EXPRESSION)) {
      auto fe_node = static_cast<FieldExpressionNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 3) {
+     if (state.production_index() == 0 && node->children.size() >= 3) {
        fe_node->postfix_expression = std::move(node->children[0]);
        fe_node->identifier = static_cast<IdentifierNode*>(node->children[2].get())->value;
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::INDEX_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::INDEX_EXPRESSION)) {
      auto ie_node = static_cast<IndexExpressionNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 4) {
+     if (state.production_index() == 0 && node->children.size() >= 4) {
        ie_node->postfix_expression = std::move(node->children[0]);
        ie_node->expression = std::move(node->children[2]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::BORROW_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::BORROW_EXPRESSION)) {
      auto be_node = static_cast<BorrowExpressionNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 3) {
+     if (state.production_index() == 0 && node->children.size() >= 3) {
        be_node->ampersand = "&";
        be_node->mut = "mut";
        be_node->unary_operator_expression = std::move(node->children[2]);
-     } else if (state.production_index == 1 && node->children.size() >= 2) {
+     } else if (state.production_index() == 1 && node->children.size() >= 2) {
        be_node->ampersand = "&";
        be_node->unary_operator_expression = std::move(node->children[1]);
-     } else if (state.production_index == 2 && node->children.size() >= 3) {
+     } else if (state.production_index() == 2 && node->children.size() >= 3) {
        be_node->ampersand = "&&";
        be_node->mut = "mut";
        be_node->unary_operator_expression = std::move(node->children[2]);
-     } else if (state.production_index == 3 && node->children.size() >= 2) {
+     } else if (state.production_index() == 3 && node->children.size() >= 2) {
        be_node->ampersand = "&&";
        be_node->unary_operator_expression = std::move(node->children[1]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::DEREFERENCE_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::DEREFERENCE_EXPRESSION)) {
      auto de_node = static_cast<DereferenceExpressionNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 2) {
+     if (state.production_index() == 0 && node->children.size() >= 2) {
        de_node->unary_operator_expression = std::move(node->children[1]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::EXPRESSION_WITH_BLOCK)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::EXPRESSION_WITH_BLOCK)) {
      auto ewb_node = static_cast<ExpressionWithBlockNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        ewb_node->block_expression = std::move(node->children[0]);
-     } else if (state.production_index == 1) {
+     } else if (state.production_index() == 1) {
        ewb_node->loop_expression = std::move(node->children[0]);
      } else {
        ewb_node->if_expression = std::move(node->children[0]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::CONTINUE_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::CONTINUE_EXPRESSION)) {
      auto ce_node = static_cast<ContinueExpressionNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        ce_node->value = "continue";
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::BREAK_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::BREAK_EXPRESSION)) {
      auto be_node = static_cast<BreakExpressionNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 2) {
+     if (state.production_index() == 0 && node->children.size() >= 2) {
        be_node->flow_control_expression = std::move(node->children[1]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::RETURN_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::RETURN_EXPRESSION)) {
      auto re_node = static_cast<ReturnExpressionNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 2) {
+     if (state.production_index() == 0 && node->children.size() >= 2) {
        re_node->flow_control_expression = std::move(node->children[1]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::LOOP_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::LOOP_EXPRESSION)) {
      auto le_node = static_cast<LoopExpressionNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        le_node->infinite_loop_expression = std::move(node->children[0]);
      } else {
        le_node->predicate_loop_expression = std::move(node->children[0]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::INFINITE_LOOP_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::INFINITE_LOOP_EXPRESSION)) {
      auto ile_node = static_cast<InfiniteLoopExpressionNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 2) {
+     if (state.production_index() == 0 && node->children.size() >= 2) {
        ile_node->block_expression = std::move(node->children[1]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::PREDICATE_LOOP_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::PREDICATE_LOOP_EXPRESSION)) {
      auto ple_node = static_cast<PredicateLoopExpressionNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 3) {
+     if (state.production_index() == 0 && node->children.size() >= 3) {
        ple_node->conditions = std::move(node->children[1]);
        ple_node->block_expression = std::move(node->children[2]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::IF_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::IF_EXPRESSION)) {
      auto ie_node = static_cast<IfExpressionNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 5) {
+     if (state.production_index() == 0 && node->children.size() >= 5) {
        ie_node->conditions = std::move(node->children[1]);
        ie_node->block_expression = std::move(node->children[2]);
        ie_node->else_if_expression = std::move(node->children[4]);
-     } else if (state.production_index == 1 && node->children.size() >= 5) {
+     } else if (state.production_index() == 1 && node->children.size() >= 5) {
        ie_node->conditions = std::move(node->children[1]);
        ie_node->block_expression = std::move(node->children[2]);
        ie_node->else_block_expression = std::move(node->children[4]);
-     } else if (state.production_index == 2 && node->children.size() >= 3) {
+     } else if (state.production_index() == 2 && node->children.size() >= 3) {
        ie_node->conditions = std::move(node->children[1]);
        ie_node->block_expression = std::move(node->children[2]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::CONDITIONS)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::CONDITIONS)) {
      auto c_node = static_cast<ConditionsNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 3) {
+     if (state.production_index() == 0 && node->children.size() >= 3) {
        c_node->expression = std::move(node->children[1]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::PATTERN)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::PATTERN)) {
      auto p_node = static_cast<PatternNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        p_node->identifier_pattern = std::move(node->children[0]);
-     } else if (state.production_index == 1) {
+     } else if (state.production_index() == 1) {
        p_node->wildcard_pattern = std::move(node->children[0]);
      } else {
        p_node->reference_pattern = std::move(node->children[0]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::IDENTIFIER_PATTERN)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::IDENTIFIER_PATTERN)) {
      auto ip_node = static_cast<IdentifierPatternNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 4) {
+     if (state.production_index() == 0 && node->children.size() >= 4) {
        ip_node->ref = "ref";
        ip_node->mut = "mut";
        ip_node->identifier = static_cast<IdentifierNode*>(node->children[3].get())->value;
-     } else if (state.production_index == 1 && node->children.size() >= 3) {
+     } else if (state.production_index() == 1 && node->children.size() >= 3) {
        ip_node->ref = "ref";
        ip_node->identifier = static_cast<IdentifierNode*>(node->children[2].get())->value;
-     } else if (state.production_index == 2 && node->children.size() >= 3) {
+     } else if (state.production_index() == 2 && node->children.size() >= 3) {
        ip_node->mut = "mut";
        ip_node->identifier = static_cast<IdentifierNode*>(node->children[2].get())->value;
-     } else if (state.production_index == 3 && node->children.size() >= 1) {
+     } else if (state.production_index() == 3 && node->children.size() >= 1) {
        ip_node->identifier = static_cast<IdentifierNode*>(node->children[0].get())->value;
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::WILDCARD_PATTERN)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::WILDCARD_PATTERN)) {
      auto wp_node = static_cast<WildcardPatternNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        wp_node->value = "_";
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::REFERENCE_PATTERN)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::REFERENCE_PATTERN)) {
      auto rp_node = static_cast<ReferencePatternNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 3) {
+     if (state.production_index() == 0 && node->children.size() >= 3) {
        rp_node->ampersand = "&";
        rp_node->mut = "mut";
        rp_node->pattern = std::move(node->children[2]);
-     } else if (state.production_index == 1 && node->children.size() >= 2) {
+     } else if (state.production_index() == 1 && node->children.size() >= 2) {
        rp_node->ampersand = "&";
        rp_node->pattern = std::move(node->children[1]);
-     } else if (state.production_index == 2 && node->children.size() >= 3) {
+     } else if (state.production_index() == 2 && node->children.size() >= 3) {
        rp_node->ampersand = "&&";
        rp_node->mut = "mut";
        rp_node->pattern = std::move(node->children[2]);
-     } else if (state.production_index == 3 && node->children.size() >= 2) {
+     } else if (state.production_index() == 3 && node->children.size() >= 2) {
        rp_node->ampersand = "&&";
        rp_node->pattern = std::move(node->children[1]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::TYPE)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::TYPE)) {
      auto t_node = static_cast<TypeNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        t_node->type_path = std::move(node->children[0]);
-     } else if (state.production_index == 1) {
+     } else if (state.production_index() == 1) {
        t_node->reference_type = std::move(node->children[0]);
-     } else if (state.production_index == 2) {
+     } else if (state.production_index() == 2) {
        t_node->array_type = std::move(node->children[0]);
      } else {
        t_node->unit_type = std::move(node->children[0]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::TYPE_PATH)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::TYPE_PATH)) {
      auto tp_node = static_cast<TypePathNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        tp_node->path_expr_segment = std::move(node->children[0]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::REFERENCE_TYPE)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::REFERENCE_TYPE)) {
      auto rt_node = static_cast<ReferenceTypeNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 2) {
+     if (state.production_index() == 0 && node->children.size() >= 2) {
        rt_node->mut = "mut";
        rt_node->type = std::move(node->children[1]);
-     } else if (state.production_index == 1 && node->children.size() >= 2) {
+     } else if (state.production_index() == 1 && node->children.size() >= 2) {
        rt_node->type = std::move(node->children[1]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::ARRAY_TYPE)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::ARRAY_TYPE)) {
      auto at_node = static_cast<ArrayTypeNode*>(node.get());
-     if (state.production_index == 0 && node->children.size() >= 5) {
+     if (state.production_index() == 0 && node->children.size() >= 5) {
        at_node->type = std::move(node->children[1]);
        at_node->expression = std::move(node->children[3]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::PATH_IN_EXPRESSION)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::PATH_IN_EXPRESSION)) {
      auto pie_node = static_cast<PathInExpressionNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        pie_node->path_expr_segment = std::move(node->children[0]);
-     } else if (state.production_index == 1 && node->children.size() >= 3) {
+     } else if (state.production_index() == 1 && node->children.size() >= 3) {
        pie_node->path_expr_segment = std::move(node->children[0]);
        pie_node->path_expr_segment2 = std::move(node->children[2]);
      }
-   } else if (state.nonterminal_type == static_cast<int>(Nonterminal::PATH_EXPR_SEGMENT)) {
+   } else if (state.nonterminal_type() == static_cast<int>(Nonterminal::PATH_EXPR_SEGMENT)) {
      auto pes_node = static_cast<PathExprSegmentNode*>(node.get());
-     if (state.production_index == 0) {
+     if (state.production_index() == 0) {
        pes_node->identifier = static_cast<IdentifierNode*>(node->children[0].get())->value;
-     } else if (state.production_index == 1) {
+     } else if (state.production_index() == 1) {
        pes_node->self_keyword = "Self";
-     } else if (state.production_index == 2) {
+     } else if (state.production_index() == 2) {
        pes_node->self_keyword = "self";
      }
    }
@@ -0,0 +1,363 @@
+#include "simd_scan.hpp"
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+using ScanFunction = const char *(*)(const char *, const char *);
+using LineStartFunction = void (*)(const char *, const char *, std::vector<std::uint32_t> &);
+
+/* same set as std::isspace in the C locale */
+bool is_whitespace(char c) {
+  return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+const char *skip_whitespace_scalar(const char *begin, const char *end) {
+  while (begin < end && is_whitespace(*begin)) {
+    ++begin;
+  }
+  return begin;
+}
+
+const char *find_comment_delimiter_scalar(const char *begin, const char *end) {
+  while (begin < end && *begin != '/' && *begin != '*') {
+    ++begin;
+  }
+  return begin;
+}
+
+// line starts after the newlines in [from, end), as offsets from begin
+void find_line_starts_from(const char *begin, const char *from, const char *end, std::vector<std::uint32_t> &starts) {
+  for (; from < end; ++from) {
+    if (*from == '\n') {
+      starts.push_back(static_cast<std::uint32_t>(from + 1 - begin));
+    }
+  }
+}
+
+void find_line_starts_scalar(const char *begin, const char *end, std::vector<std::uint32_t> &starts) {
+  find_line_starts_from(begin, begin, end, starts);
+}
+
+/* length of the well-formed UTF-8 sequence at begin, or 0 if it is malformed or truncated */
+std::size_t utf8_sequence_length(const char *begin, const char *end) {
+  auto byte = [&](std::size_t i) { return static_cast<unsigned char>(begin[i]); };
+  unsigned char lead = byte(0);
+  if (lead < 0x80) {
+    return 1;
+  }
+  std::size_t length;
+  unsigned char low = 0x80, high = 0xbf; // allowed range of the second byte
+  if (lead >= 0xc2 && lead <= 0xdf) {
+    length = 2;
+  } else if (lead >= 0xe0 && lead <= 0xef) {
+    length = 3;
+    if (lead == 0xe0) {
+      low = 0xa0; // overlong
+    } else if (lead == 0xed) {
+      high = 0x9f; // surrogates
+    }
+  } else if (lead >= 0xf0 && lead <= 0xf4) {
+    length = 4;
+    if (lead == 0xf0) {
+      low = 0x90; // overlong
+    } else if (lead == 0xf4) {
+      high = 0x8f; // above U+10FFFF
+    }
+  } else {
+    return 0;
+  }
+  if (static_cast<std::size_t>(end - begin) < length || byte(1) < low || byte(1) > high) {
+    return 0;
+  }
+  for (std::size_t i = 2; i < length; ++i) {
+    if ((byte(i) & 0xc0) != 0x80) {
+      return 0;
+    }
+  }
+  return length;
+}
+
+const char *validate_utf8_scalar(const char *begin, const char *end) {
+  while (begin < end) {
+    std::size_t length = utf8_sequence_length(begin, end);
+    if (length == 0) {
+      return begin;
+    }
+    begin += length;
+  }
+  return end;
+}
+
+/* first character boundary at or before position, given that [begin, position) holds only complete
+   characters except maybe a truncated one at its end */
+const char *utf8_character_start(const char *begin, const char *position) {
+  const char *start = position - std::min<std::ptrdiff_t>(3, position - begin);
+  while (start < position && (static_cast<unsigned char>(*start) & 0xc0) == 0x80) {
+    ++start;
+  }
+  return start;
+}
+
+#ifdef SIMD_SCAN_X86
+
+__attribute__((target("sse2")))
+unsigned whitespace_mask_sse2(__m128i bytes) {
+  // whitespace is ' ' or '\t' ... '\r', the latter is (byte - '\t') <= 4 as unsigned
+  __m128i shifted = _mm_sub_epi8(bytes, _mm_set1_epi8('\t'));
+  __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(4)), shifted);
+  __m128i space = _mm_cmpeq_epi8(bytes, _mm_set1_epi8(' '));
+  return static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(control, space)));
+}
+
+__attribute__((target("sse2")))
+const char *skip_whitespace_sse2(const char *begin, const char *end) {
+  while (end - begin >= 16) {
+    unsigned mask = whitespace_mask_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i *>(begin)));
+    if (mask != 0xffff) {
+      return begin + __builtin_ctz(~mask);
+    }
+    begin += 16;
+  }
+  return skip_whitespace_scalar(begin, end);
+}
+
+__attribute__((target("sse2")))
+const char *find_comment_delimiter_sse2(const char *begin, const char *end) {
+  while (end - begin >= 16) {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+    __m128i found = _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('/')), _mm_cmpeq_epi8(bytes, _mm_set1_epi8('*')));
+    unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(found));
+    if (mask != 0) {
+      return begin + __builtin_ctz(mask);
+    }
+    begin += 16;
+  }
+  return find_comment_delimiter_scalar(begin, end);
+}
+
+__attribute__((target("sse2")))
+void find_line_starts_sse2(const char *begin, const char *end, std::vector<std::uint32_t> &starts) {
+  const char *block = begin;
+  for (; end - block >= 16; block += 16) {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block));
+    unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n'))));
+    for (; mask != 0; mask &= mask - 1) {
+      starts.push_back(static_cast<std::uint32_t>(block + __builtin_ctz(mask) + 1 - begin));
+    }
+  }
+  find_line_starts_from(begin, block, end, starts);
+}
+
+// skips ASCII 16 bytes at a time and checks the other characters one by one
+__attribute__((target("sse2")))
+const char *validate_utf8_sse2(const char *begin, const char *end) {
+  while (end - begin >= 16) {
+    unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(begin))));
+    if (mask == 0) {
+      begin += 16;
+      continue;
+    }
+    begin += __builtin_ctz(mask);
+    std::size_t length = utf8_sequence_length(begin, end);
+    if (length == 0) {
+      return begin;
+    }
+    begin += length;
+  }
+  return validate_utf8_scalar(begin, end);
+}
+
+__attribute__((target("avx2")))
+const char *skip_whitespace_avx2(const char *begin, const char *end) {
+  while (end - begin >= 32) {
+    __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+    __m256i shifted = _mm256_sub_epi8(bytes, _mm256_set1_epi8('\t'));
+    __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8(4)), shifted);
+    __m256i space = _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' '));
+    unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_or_si256(control, space)));
+    if (mask != 0xffffffffu) {
+      return begin + __builtin_ctz(~mask);
+    }
+    begin += 32;
+  }
+  return skip_whitespace_sse2(begin, end);
+}
+
+__attribute__((target("avx2")))
+const char *find_comment_delimiter_avx2(const char *begin, const char *end) {
+  while (end - begin >= 32) {
+    __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+    __m256i found = _mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('/')),
+                                    _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('*')));
+    unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(found));
+    if (mask != 0) {
+      return begin + __builtin_ctz(mask);
+    }
+    begin += 32;
+  }
+  return find_comment_delimiter_sse2(begin, end);
+}
+
+__attribute__((target("avx2")))
+void find_line_starts_avx2(const char *begin, const char *end, std::vector<std::uint32_t> &starts) {
+  const char *block = begin;
+  for (; end - block >= 32; block += 32) {
+    __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block));
+    unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\n'))));
+    for (; mask != 0; mask &= mask - 1) {
+      starts.push_back(static_cast<std::uint32_t>(block + __builtin_ctz(mask) + 1 - begin));
+    }
+  }
+  find_line_starts_from(begin, block, end, starts);
+}
+
+/* the bytes N positions before each byte of input, taken from the end of previous where needed */
+template <int N>
+__attribute__((target("avx2")))
+__m256i previous_bytes_avx2(__m256i input, __m256i previous) {
+  return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(previous, input, 0x21), 16 - N);
+}
+
+__attribute__((target("avx2")))
+__m256i high_nibbles_avx2(__m256i bytes) {
+  return _mm256_and_si256(_mm256_srli_epi16(bytes, 4), _mm256_set1_epi8(0x0f));
+}
+
+/* nonzero bytes where a sequence is malformed, after Keiser and Lemire, "Validating UTF-8 in less
+   than one instruction per byte": three nibble lookups classify each pair of adjacent bytes, and
+   the third and fourth bytes of long sequences are checked against the lead bytes before them */
+__attribute__((target("avx2")))
+__m256i utf8_errors_avx2(__m256i input, __m256i previous) {
+  constexpr char too_short = 1 << 0;  // lead byte not followed by a continuation
+  constexpr char too_long = 1 << 1;   // ASCII followed by a continuation
+  constexpr char overlong_3 = 1 << 2;
+  constexpr char too_large = 1 << 3;
+  constexpr char surrogate = 1 << 4;
+  constexpr char overlong_2 = 1 << 5;
+  constexpr char too_large_1000 = 1 << 6;
+  constexpr char overlong_4 = 1 << 6;
+  constexpr char two_continuations = static_cast<char>(1 << 7);
+  constexpr char carry = too_short | too_long | two_continuations;
+
+  __m256i previous1 = previous_bytes_avx2<1>(input, previous);
+  __m256i byte_1_high = _mm256_shuffle_epi8(_mm256_setr_epi8(
+    too_long, too_long, too_long, too_long, too_long, too_long, too_long, too_long,
+    two_continuations, two_continuations, two_continuations, two_continuations,
+    too_short | overlong_2, too_short, too_short | overlong_3 | surrogate,
+    too_short | too_large | too_large_1000 | overlong_4,
+    too_long, too_long, too_long, too_long, too_long, too_long, too_long, too_long,
+    two_continuations, two_continuations, two_continuations, two_continuations,
+    too_short | overlong_2, too_short, too_short | overlong_3 | surrogate,
+    too_short | too_large | too_large_1000 | overlong_4), high_nibbles_avx2(previous1));
+  __m256i byte_1_low = _mm256_shuffle_epi8(_mm256_setr_epi8(
+    carry | overlong_3 | overlong_2 | overlong_4, carry | overlong_2, carry, carry,
+    carry | too_large, carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000, carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000, carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000 | surrogate, carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000,
+    carry | overlong_3 | overlong_2 | overlong_4, carry | overlong_2, carry, carry,
+    carry | too_large, carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000, carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000, carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000 | surrogate, carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000), _mm256_and_si256(previous1, _mm256_set1_epi8(0x0f)));
+  constexpr char continuation_80 = too_long | overlong_2 | two_continuations | overlong_3 | too_large_1000 | overlong_4;
+  constexpr char continuation_90 = too_long | overlong_2 | two_continuations | overlong_3 | too_large;
+  constexpr char continuation_a0 = too_long | overlong_2 | two_continuations | surrogate | too_large;
+  __m256i byte_2_high = _mm256_shuffle_epi8(_mm256_setr_epi8(
+    too_short, too_short, too_short, too_short, too_short, too_short, too_short, too_short,
+    continuation_80, continuation_90, continuation_a0, continuation_a0,
+    too_short, too_short, too_short, too_short,
+    too_short, too_short, too_short, too_short, too_short, too_short, too_short, too_short,
+    continuation_80, continuation_90, continuation_a0, continuation_a0,
+    too_short, too_short, too_short, too_short), high_nibbles_avx2(input));
+  __m256i special = _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+
+  // bytes two after a 3 or 4 byte lead, or three after a 4 byte lead, must be continuations
+  __m256i third = _mm256_subs_epu8(previous_bytes_avx2<2>(input, previous), _mm256_set1_epi8(0xe0 - 0x80));
+  __m256i fourth = _mm256_subs_epu8(previous_bytes_avx2<3>(input, previous), _mm256_set1_epi8(0xf0 - 0x80));
+  __m256i must_continue = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(static_cast<char>(0x80)));
+  return _mm256_xor_si256(must_continue, special);
+}
+
+__attribute__((target("avx2")))
+const char *validate_utf8_avx2(const char *begin, const char *end) {
+  // nonzero where a lead byte at the end of a block still expects continuations
+  const __m256i incomplete_limits = _mm256_setr_epi8(
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    static_cast<char>(0xf0 - 1), static_cast<char>(0xe0 - 1), static_cast<char>(0xc0 - 1));
+  const char *position = begin;
+  __m256i previous = _mm256_setzero_si256();
+  __m256i incomplete = _mm256_setzero_si256();
+  while (end - position >= 32) {
+    __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(position));
+    __m256i errors;
+    if (_mm256_movemask_epi8(input) == 0) {
+      // an ASCII block cannot continue a sequence left open by the block before it
+      errors = incomplete;
+      incomplete = _mm256_setzero_si256();
+    } else {
+      // open sequences are checked by the lookups, which see the end of the previous block
+      errors = utf8_errors_avx2(input, previous);
+      incomplete = _mm256_subs_epu8(input, incomplete_limits);
+    }
+    if (!_mm256_testz_si256(errors, errors)) {
+      break;
+    }
+    previous = input;
+    position += 32;
+  }
+  // the tail, or the block with an error, is checked again byte by byte to find the exact position
+  return validate_utf8_scalar(utf8_character_start(begin, position), end);
+}
+
+#endif
+
+template <typename Function>
+Function select(Function scalar, [[maybe_unused]] Function sse2, [[maybe_unused]] Function avx2) {
+#ifdef SIMD_SCAN_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return avx2;
+  }
+  if (__builtin_cpu_supports("sse2")) {
+    return sse2;
+  }
+#endif
+  return scalar;
+}
+
+#ifdef SIMD_SCAN_X86
+#define SIMD_SCAN_SELECT(name) select(name##_scalar, name##_sse2, name##_avx2)
+#else
+#define SIMD_SCAN_SELECT(name) select(name##_scalar, name##_scalar, name##_scalar)
+#endif
+
+} // namespace
+
+const char *skip_whitespace(const char *begin, const char *end) {
+  static const ScanFunction implementation = SIMD_SCAN_SELECT(skip_whitespace);
+  return implementation(begin, end);
+}
+
+const char *find_comment_delimiter(const char *begin, const char *end) {
+  static const ScanFunction implementation = SIMD_SCAN_SELECT(find_comment_delimiter);
+  return implementation(begin, end);
+}
+
+void find_line_starts(const char *begin, const char *end, std::vector<std::uint32_t> &starts) {
+  static const LineStartFunction implementation = SIMD_SCAN_SELECT(find_line_starts);
+  implementation(begin, end, starts);
+}
+
+const char *validate_utf8(const char *begin, const char *end) {
+  static const ScanFunction implementation = SIMD_SCAN_SELECT(validate_utf8);
+  return implementation(begin, end);
+}
@@ -0,0 +1,120 @@
+#include "source.hpp"
+#include "simd_scan.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <system_error>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+[[noreturn]] void throw_errno(const std::string &what) {
+  throw std::system_error(errno, std::generic_category(), what);
+}
+
+/* reads until end of file in large chunks, for inputs that cannot be mapped such as pipes */
+std::string read_all(int fd, const std::string &name) {
+  std::string content(1 << 16, '\0');
+  std::size_t used = 0;
+  while (true) {
+    if (used == content.size()) {
+      content.resize(content.size() * 2);
+    }
+    ssize_t count = read(fd, content.data() + used, content.size() - used);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw_errno("cannot read " + name);
+    }
+    if (count == 0) {
+      break;
+    }
+    used += static_cast<std::size_t>(count);
+  }
+  content.resize(used);
+  return content;
+}
+
+} // namespace
+
+SourceBuffer::SourceBuffer(std::string name, std::string content)
+    : buffer_name{std::move(name)}, content{std::move(content)}, bytes{this->content} {}
+
+SourceBuffer::SourceBuffer(std::string name, int fd, std::size_t size) : buffer_name{std::move(name)} {
+  if (size == 0) {
+    return; // mmap rejects empty mappings
+  }
+  mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (mapping == MAP_FAILED) {
+    mapping = nullptr;
+    throw_errno("cannot map " + buffer_name);
+  }
+  mapping_size = size;
+  madvise(mapping, size, MADV_SEQUENTIAL);
+  bytes = std::string_view(static_cast<const char *>(mapping), size);
+}
+
+SourceBuffer::~SourceBuffer() {
+  if (mapping) {
+    munmap(mapping, mapping_size);
+  }
+}
+
+const std::string &SourceBuffer::name() const {
+  return buffer_name;
+}
+
+std::string_view SourceBuffer::text() const {
+  return bytes;
+}
+
+SourceLocation SourceBuffer::location(std::uint32_t offset) const {
+  std::call_once(line_table_built, [this] {
+    line_starts.push_back(0);
+    find_line_starts(bytes.data(), bytes.data() + bytes.size(), line_starts);
+  });
+  auto line = std::upper_bound(line_starts.begin(), line_starts.end(), offset) - 1;
+  return {static_cast<std::uint32_t>(line - line_starts.begin() + 1), offset - *line + 1};
+}
+
+const SourceBuffer &SourceManager::add(std::string name, std::string content) {
+  buffers.push_back(std::make_unique<SourceBuffer>(std::move(name), std::move(content)));
+  return *buffers.back();
+}
+
+const SourceBuffer &SourceManager::add_file(const std::string &path) {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    throw_errno("cannot open " + path);
+  }
+  try {
+    const SourceBuffer &buffer = add_descriptor(path, fd);
+    close(fd);
+    return buffer;
+  } catch (...) {
+    close(fd);
+    throw;
+  }
+}
+
+const SourceBuffer &SourceManager::add_stdin() {
+  return add_descriptor("<stdin>", STDIN_FILENO);
+}
+
+const SourceBuffer &SourceManager::add_descriptor(std::string name, int fd) {
+  struct stat info;
+  if (fstat(fd, &info) < 0) {
+    throw_errno("cannot stat " + name);
+  }
+  if (S_ISREG(info.st_mode)) {
+    buffers.push_back(std::make_unique<SourceBuffer>(std::move(name), fd, static_cast<std::size_t>(info.st_size)));
+  } else {
+    std::string content = read_all(fd, name);
+    buffers.push_back(std::make_unique<SourceBuffer>(std::move(name), std::move(content)));
+  }
+  return *buffers.back();
+}
@@ -0,0 +1,91 @@
+#include "symbol_table.hpp"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+namespace {
+
+constexpr std::size_t arena_block_size = 1 << 16;
+
+std::size_t hash_spelling(std::string_view spelling) {
+  return std::hash<std::string_view>{}(spelling);
+}
+
+}  // namespace
+
+SymbolId SymbolTable::intern(std::string_view spelling) {
+  // keep the load factor at most one half
+  if ((spellings.size() + 1) * 2 > slots.size()) {
+    grow();
+  }
+  std::size_t hash = hash_spelling(spelling);
+  std::size_t mask = slots.size() - 1;
+  for (std::size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+    SymbolId entry = slots[slot];
+    if (entry == 0) {
+      SymbolId id = static_cast<SymbolId>(spellings.size());
+      spellings.push_back(store(spelling));
+      hashes.push_back(hash);
+      slots[slot] = id + 1;
+      return id;
+    }
+    if (hashes[entry - 1] == hash && spellings[entry - 1] == spelling) {
+      return entry - 1;
+    }
+  }
+}
+
+std::optional<SymbolId> SymbolTable::find(std::string_view spelling) const {
+  if (slots.empty()) {
+    return std::nullopt;
+  }
+  std::size_t hash = hash_spelling(spelling);
+  std::size_t mask = slots.size() - 1;
+  for (std::size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+    SymbolId entry = slots[slot];
+    if (entry == 0) {
+      return std::nullopt;
+    }
+    if (hashes[entry - 1] == hash && spellings[entry - 1] == spelling) {
+      return entry - 1;
+    }
+  }
+}
+
+// copies the spelling into the arena; blocks are never moved, so earlier views stay valid
+std::string_view SymbolTable::store(std::string_view spelling) {
+  if (spelling.empty()) {
+    return {};
+  }
+  if (spelling.size() > block_size - block_used) {
+    block_size = std::max(arena_block_size, spelling.size());
+    blocks.push_back(std::make_unique<char[]>(block_size));
+    block_used = 0;
+  }
+  char *data = blocks.back().get() + block_used;
+  std::memcpy(data, spelling.data(), spelling.size());
+  block_used += spelling.size();
+  return std::string_view(data, spelling.size());
+}
+
+void SymbolTable::clear() {
+  if (blocks.size() > 1) {
+    blocks.erase(blocks.begin(), blocks.end() - 1);
+  }
+  block_used = 0;
+  spellings.clear();
+  hashes.clear();
+  std::fill(slots.begin(), slots.end(), 0);
+}
+
+void SymbolTable::grow() {
+  slots.assign(slots.empty() ? 64 : slots.size() * 2, 0);
+  std::size_t mask = slots.size() - 1;
+  for (SymbolId id = 0; id < spellings.size(); ++id) {
+    std::size_t slot = hashes[id] & mask;
+    while (slots[slot] != 0) {
+      slot = (slot + 1) & mask;
+    }
+    slots[slot] = id + 1;
+  }
+}
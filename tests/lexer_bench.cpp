@@ -0,0 +1,218 @@
+#include "lexer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+/* lexer throughput over the test cases, over the test cases concatenated to 1/10/100 MB (lexed by
+   lex() and by lex_parallel(), which the driver uses) and over adversarial inputs; prints one JSON
+   object per corpus so results can be diffed between versions.
+
+   usage: lexer_bench [testcase directory] [--filter=substring] [--min-time=seconds] */
+
+#ifndef LEXER_BENCH_TESTCASES
+#define LEXER_BENCH_TESTCASES "RCompiler-Testcases"
+#endif
+
+namespace {
+
+struct Corpus {
+  std::string name;
+  std::vector<std::string> files; // lexed one after another, each as a separate input
+  bool parallel = false;           // lexed by lex_parallel() on one thread per core
+};
+
+struct Result {
+  std::size_t bytes = 0;
+  std::size_t tokens = 0;
+  std::size_t iterations = 0;
+  double seconds = 0; // fastest pass over the whole corpus
+};
+
+// used when the test cases are not checked out, so the concatenated corpora still have content
+constexpr std::string_view fallback_source = R"(// sum of the first n squares
+fn square_sum(n: i32) -> i32 {
+    let mut total: i32 = 0;
+    let mut i: i32 = 1;
+    while i <= n {
+        total += i * i;
+        i += 1;
+    }
+    /* squares grow fast, so keep n small */
+    return total;
+}
+
+struct Point { x: i64, y: i64 }
+
+impl Point {
+    fn norm(&self) -> i64 { self.x * self.x + self.y * self.y }
+}
+
+fn main() {
+    let p = Point { x: 3, y: 4 };
+    let s: &str = "norm of p:\t";
+    printInt(p.norm() + square_sum(10) as i64);
+    if p.x != 0 && p.y >= 0x10 { exit(0); } else { exit(1); }
+}
+)";
+
+std::vector<std::string> read_testcases(const std::filesystem::path &directory) {
+  std::vector<std::string> files;
+  std::error_code error;
+  if (!std::filesystem::is_directory(directory, error)) {
+    return files;
+  }
+  std::vector<std::filesystem::path> paths;
+  for (const auto &entry : std::filesystem::recursive_directory_iterator(directory, error)) {
+    if (entry.is_regular_file() && entry.path().extension() == ".rx") {
+      paths.push_back(entry.path());
+    }
+  }
+  std::sort(paths.begin(), paths.end());
+  for (const auto &path : paths) {
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    // some test cases are meant to fail; only inputs the lexer accepts are measured
+    try {
+      lex(buffer.str());
+      files.push_back(buffer.str());
+    } catch (const LexerError &) {
+    }
+  }
+  return files;
+}
+
+// whole files repeated up to size bytes; newlines keep a trailing line comment from running on
+std::string concatenate(const std::vector<std::string> &files, std::size_t size) {
+  std::string text;
+  text.reserve(size + 4096);
+  while (text.size() < size) {
+    for (const auto &file : files) {
+      text += file;
+      text += '\n';
+      if (text.size() >= size) {
+        break;
+      }
+    }
+  }
+  return text;
+}
+
+std::string long_string_literal(std::size_t size) {
+  std::string text = "let s = \"";
+  while (text.size() < size) {
+    text += "a long string literal with \\\"escapes\\\" and caf\xc3\xa9 \\n";
+  }
+  return text + "\";\n";
+}
+
+std::string nested_comments(std::size_t size) {
+  std::string text;
+  while (text.size() < size) {
+    for (int depth = 0; depth < 1000; ++depth) {
+      text += "/* ";
+    }
+    text += "deep";
+    for (int depth = 0; depth < 1000; ++depth) {
+      text += " */";
+    }
+    text += '\n';
+  }
+  return text;
+}
+
+std::string punctuation_runs(std::size_t size) {
+  // no '/', which would start comments
+  constexpr std::string_view run = "<<=>>=..=...<=>===!=&&||<<>>+=-=*=%=^=&=|=..::->=>=<>!~+-*%^&|@.,;:#$?{}[]()";
+  std::string text;
+  while (text.size() < size) {
+    text += run;
+    text += '\n';
+  }
+  return text;
+}
+
+Result measure(const Corpus &corpus, double min_time) {
+  Result result;
+  for (const auto &file : corpus.files) {
+    result.bytes += file.size();
+  }
+  double total = 0;
+  while (result.iterations < 3 || total < min_time) {
+    std::size_t tokens = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto &file : corpus.files) {
+      tokens += (corpus.parallel ? lex_parallel(file) : lex(file)).size();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.tokens = tokens;
+    result.seconds = result.iterations == 0 ? seconds : std::min(result.seconds, seconds);
+    total += seconds;
+    ++result.iterations;
+  }
+  return result;
+}
+
+void print(const std::string &name, const Result &result) {
+  double seconds = std::max(result.seconds, 1e-9);
+  std::cout << "{\"corpus\": \"" << name << "\", \"bytes\": " << result.bytes << ", \"tokens\": " << result.tokens
+            << ", \"iterations\": " << result.iterations << ", \"seconds\": " << result.seconds
+            << ", \"mb_per_s\": " << result.bytes / seconds / 1e6 << ", \"tokens_per_s\": " << result.tokens / seconds
+            << "}" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  std::string directory = LEXER_BENCH_TESTCASES, filter;
+  double min_time = 0.5;
+  for (int i = 1; i < argc; ++i) {
+    std::string_view arg = argv[i];
+    if (arg.starts_with("--filter=")) {
+      filter = arg.substr(9);
+    } else if (arg.starts_with("--min-time=")) {
+      min_time = std::atof(argv[i] + 11);
+    } else {
+      directory = arg;
+    }
+  }
+
+  std::vector<std::string> testcases = read_testcases(directory);
+  // named apart, so results from a machine without the test cases are not mistaken for real ones
+  std::string testcases_name = "testcases";
+  if (testcases.empty()) {
+    std::cerr << "lexer_bench: no test cases under " << directory << ", using a built-in sample" << std::endl;
+    testcases.emplace_back(fallback_source);
+    testcases_name = "builtin_sample";
+  }
+
+  // corpora are built one at a time, so the 100 MB one is not kept around with the others
+  constexpr std::size_t megabyte = 1 << 20;
+  std::vector<std::tuple<std::string, bool, std::function<std::vector<std::string>()>>> corpora = {
+    {testcases_name, false, [&] { return testcases; }},
+    {"concat_1mb", false, [&] { return std::vector{concatenate(testcases, megabyte)}; }},
+    {"concat_1mb_parallel", true, [&] { return std::vector{concatenate(testcases, megabyte)}; }},
+    {"concat_10mb", false, [&] { return std::vector{concatenate(testcases, 10 * megabyte)}; }},
+    {"concat_10mb_parallel", true, [&] { return std::vector{concatenate(testcases, 10 * megabyte)}; }},
+    {"concat_100mb", false, [&] { return std::vector{concatenate(testcases, 100 * megabyte)}; }},
+    {"concat_100mb_parallel", true, [&] { return std::vector{concatenate(testcases, 100 * megabyte)}; }},
+    {"long_string", false, [] { return std::vector{long_string_literal(10 * megabyte)}; }},
+    {"nested_comments", false, [] { return std::vector{nested_comments(10 * megabyte)}; }},
+    {"punctuation", false, [] { return std::vector{punctuation_runs(10 * megabyte)}; }},
+  };
+  for (const auto &[name, parallel, build] : corpora) {
+    if (name.find(filter) != std::string::npos) {
+      print(name, measure(Corpus{name, build(), parallel}, min_time));
+    }
+  }
+  return 0;
+}
@@ -255,6 +255,218 @@ TEST(LexerTest, CommentInStringLex) {
   }
 }
 
+TEST(LexerTest, TokensReferenceInput) {
+  string input = "let x = \"s\";";
+  auto tokens = lex(input);
+  ASSERT_EQ(tokens.size(), 5);
+  EXPECT_EQ(tokens[0].value.data(), input.data());
+  EXPECT_EQ(tokens[1].value.data(), input.data() + 4);
+  EXPECT_EQ(tokens[3].value.data(), input.data() + 8);
+  EXPECT_EQ(tokens[3].value.size(), 3);
+}
+
+TEST(LexerTest, KeywordMatch) {
+  auto tokens = lex("mut self Self selfish while where");
+  ASSERT_EQ(tokens.size(), 6);
+  EXPECT_TRUE(Token(Token::Type::Keyword, "mut").match(tokens[0]));
+  EXPECT_FALSE(Token(Token::Type::Keyword, "mut").match(tokens[1]));
+  EXPECT_TRUE(Token(Token::Type::Keyword, "self").match(tokens[1]));
+  EXPECT_FALSE(Token(Token::Type::Keyword, "self").match(tokens[2]));
+  EXPECT_EQ(tokens[3].type, Token::Type::Identifier);
+  EXPECT_TRUE(Token(Token::Type::Keyword, "while").match(tokens[4]));
+  EXPECT_FALSE(Token(Token::Type::Keyword, "while").match(tokens[5]));
+}
+
+TEST(LexerTest, PunctuationMatch) {
+  auto tokens = lex("<<= <<< ..= ... :: :");
+  std::vector<string> expected_values = {"<<=", "<<", "<", "..=", "...", "::", ":"};
+  ASSERT_EQ(tokens.size(), expected_values.size());
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    EXPECT_EQ(tokens[i].value, expected_values[i]);
+    EXPECT_TRUE(Token(Token::Type::Punctuation, expected_values[i]).match(tokens[i]));
+  }
+  EXPECT_FALSE(Token(Token::Type::Punctuation, "<").match(tokens[1]));
+  EXPECT_FALSE(Token(Token::Type::Punctuation, ":").match(tokens[5]));
+}
+
+TEST(LexerTest, TokenKinds) {
+  for (size_t k = first_keyword_kind; k < token_kind_count; ++k) {
+    auto kind = static_cast<TokenKind>(k);
+    auto tokens = lex(token_spelling(kind));
+    ASSERT_EQ(tokens.size(), 1);
+    EXPECT_EQ(tokens[0].kind, kind);
+    EXPECT_EQ(tokens[0].type, token_type(kind));
+    EXPECT_TRUE(Token(kind).match(tokens[0]));
+  }
+  EXPECT_EQ(Token(Token::Type::Keyword, "Self").kind, TokenKind::KwSelfType);
+  EXPECT_EQ(Token(Token::Type::Punctuation, "::").kind, TokenKind::PathSep);
+  EXPECT_EQ(Token(TokenKind::Semi).value, ";");
+  EXPECT_EQ(lex("x")[0].kind, TokenKind::Identifier);
+  EXPECT_THROW(Token(Token::Type::Punctuation), std::runtime_error);
+}
+
+TEST(LexerTest, StreamingLexer) {
+  string input = "fn main() { /* c */ x += 1; } // end";
+  auto tokens = lex(input);
+  Lexer lexer(input);
+  size_t i = 0;
+  for (const Token &token : lexer) {
+    ASSERT_LT(i, tokens.size());
+    EXPECT_EQ(token.type, tokens[i].type);
+    EXPECT_EQ(token.value, tokens[i].value);
+    ++i;
+  }
+  EXPECT_EQ(i, tokens.size());
+  EXPECT_FALSE(lexer.next().has_value());
+}
+
+TEST(LexerTest, TokenBufferMatch) {
+  auto tokens = lex("let x += 42");
+  ASSERT_EQ(tokens.size(), 4);
+  EXPECT_TRUE(tokens.matches(0, Token(Token::Type::Keyword, "let")));
+  EXPECT_FALSE(tokens.matches(0, Token(Token::Type::Keyword, "mut")));
+  EXPECT_TRUE(tokens.matches(1, Token(Token::Type::Identifier)));
+  EXPECT_TRUE(tokens.matches(1, Token(Token::Type::Identifier, "x")));
+  EXPECT_TRUE(tokens.matches(2, Token(Token::Type::Punctuation, "+=")));
+  EXPECT_FALSE(tokens.matches(2, Token(Token::Type::Punctuation, "+")));
+  EXPECT_FALSE(tokens.matches(3, Token(Token::Type::Identifier)));
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    EXPECT_EQ(tokens.matches(i, Token(Token::Type::Punctuation, "+=")),
+              Token(Token::Type::Punctuation, "+=").match(tokens[i]));
+  }
+}
+
+TEST(LexerTest, SymbolInterning) {
+  string input = "x y let x \"s\" 1 \"s\" x";
+  auto tokens = lex(input);
+  ASSERT_EQ(tokens.size(), 8);
+  EXPECT_EQ(tokens.symbol(0), tokens.symbol(3));
+  EXPECT_EQ(tokens.symbol(0), tokens.symbol(7));
+  EXPECT_NE(tokens.symbol(0), tokens.symbol(1));
+  EXPECT_EQ(tokens.symbol(4), tokens.symbol(6));
+  EXPECT_EQ(tokens.symbol(2), SymbolTable::none);
+  EXPECT_EQ(tokens.symbols().size(), 4);
+  EXPECT_EQ(tokens.symbols().spelling(tokens.symbol(4)), "\"s\"");
+  EXPECT_EQ(tokens.symbols().find("y"), tokens.symbol(1));
+  EXPECT_FALSE(tokens.symbols().find("z").has_value());
+}
+
+TEST(LexerTest, LiteralDecoding) {
+  string input = R"(42 0x1F_u8 0b1010 1_000i64 'a' '\n' "caf)" "\xc3\xa9" R"(\t\"" "a")";
+  auto tokens = lex(input);
+  ASSERT_EQ(tokens.size(), 8);
+  EXPECT_EQ(tokens.literal(0).integer, 42);
+  EXPECT_EQ(tokens.literal(0).suffix, Literal::Suffix::None);
+  EXPECT_EQ(tokens.literal(1).integer, 31);
+  EXPECT_EQ(tokens.literal(1).suffix, Literal::Suffix::U8);
+  EXPECT_EQ(tokens.literal(2).integer, 10);
+  EXPECT_EQ(tokens.literal(3).integer, 1000);
+  EXPECT_EQ(tokens.literal(3).suffix, Literal::Suffix::I64);
+  const auto &pool = tokens.literal_pool();
+  EXPECT_EQ(pool.spelling(tokens.literal(4).string), "a");
+  EXPECT_EQ(pool.spelling(tokens.literal(5).string), "\n");
+  EXPECT_EQ(pool.spelling(tokens.literal(6).string), "caf\xc3\xa9\t\"");
+  // equal contents share one pool entry, whatever the quoting
+  EXPECT_EQ(tokens.literal(7).string, tokens.literal(4).string);
+}
+
+TEST(LexerTest, ClearForgetsLiterals) {
+  // as the streaming parser without kept tokens uses it: one token at a time
+  string input = "x 1 \"a\" y 2 \"b\" x 3u8";
+  TokenBuffer buffer(input);
+  Lexer lexer(input);
+  auto tokens = lex(input);
+  size_t i = 0;
+  for (const Token &token : lexer) {
+    buffer.clear();
+    buffer.push_back(token);
+    EXPECT_EQ(buffer.symbol(0), 0);
+    EXPECT_EQ(buffer.symbols().size(), 1);
+    EXPECT_LE(buffer.literal_pool().size(), 1);
+    if (token.type == Token::Type::IntegerLiteral) {
+      EXPECT_EQ(buffer.literal(0).integer, tokens.literal(i).integer);
+      EXPECT_EQ(buffer.literal(0).suffix, tokens.literal(i).suffix);
+    } else if (token.type == Token::Type::StringLiteral) {
+      EXPECT_EQ(buffer.literal_pool().spelling(buffer.literal(0).string),
+                tokens.literal_pool().spelling(tokens.literal(i).string));
+    }
+    ++i;
+  }
+  EXPECT_EQ(i, tokens.size());
+}
+
+TEST(LexerTest, TokenOffsets) {
+  string input = "let x = 42; // c\n  y";
+  auto tokens = lex(input);
+  ASSERT_EQ(tokens.size(), 6);
+  std::vector<uint32_t> expected_offsets = {0, 4, 6, 8, 10, 19};
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    EXPECT_EQ(tokens[i].offset, expected_offsets[i]);
+    EXPECT_EQ(tokens[i].value.data(), input.data() + tokens[i].offset);
+  }
+}
+
+TEST(LexerTest, Trivia) {
+  string input = "  let x /* a */ = 42; // b\n";
+  auto tokens = lex(input, true);
+  ASSERT_EQ(tokens.size(), 5);
+  ASSERT_EQ(tokens.trivia_count(0), 1);
+  EXPECT_EQ(tokens.trivia(0, 0).value, "  ");
+  EXPECT_EQ(tokens.trivia_count(1), 1);
+  ASSERT_EQ(tokens.trivia_count(2), 3);
+  EXPECT_EQ(tokens.trivia(2, 1).type, Token::Type::Comment);
+  EXPECT_EQ(tokens.trivia(2, 1).value, "/* a */");
+  EXPECT_EQ(tokens.trivia(2, 2).offset, 15);
+  EXPECT_EQ(tokens.trivia_count(4), 0);
+  ASSERT_EQ(tokens.trivia_count(5), 3);
+  EXPECT_EQ(tokens.trivia(5, 2).value, "\n");
+
+  string rebuilt;
+  for (size_t i = 0; i <= tokens.size(); ++i) {
+    for (size_t piece = 0; piece < tokens.trivia_count(i); ++piece) {
+      rebuilt += tokens.trivia(i, piece).value;
+    }
+    if (i < tokens.size()) {
+      rebuilt += tokens.value(i);
+    }
+  }
+  EXPECT_EQ(rebuilt, input);
+  EXPECT_EQ(lex(input).trivia_count(0), 0);
+}
+
+TEST(LexerTest, Relex) {
+  struct Case {
+    string before;
+    SourceEdit edit;
+    size_t first, old_end, new_end;
+  };
+  std::vector<Case> cases = {
+    {"let x = 42; let y = x;", {8, 2, "7"}, 3, 4, 4},         // replace a literal
+    {"let x = 42; let y = x;", {5, 0, "yz"}, 1, 2, 2},        // extend a token ending at the edit
+    {"let x = 42; let y = x;", {11, 0, " /* c */"}, 4, 5, 5}, // insert trivia
+    {"a /* b */ c d e", {5, 0, "*/ x /*"}, 1, 1, 2},           // open up a comment
+    {"a b c d", {2, 5, ""}, 1, 4, 1},                          // delete to the end
+  };
+  for (const auto &c : cases) {
+    string after = c.before.substr(0, c.edit.offset) + string(c.edit.inserted) +
+                   c.before.substr(c.edit.offset + c.edit.removed);
+    SourceEdit edit = c.edit;
+    edit.inserted = std::string_view(after).substr(edit.offset, edit.inserted.size());
+    auto [tokens, changed] = relex(lex(c.before), after, edit);
+    auto expected = lex(after);
+    ASSERT_EQ(tokens.size(), expected.size()) << after;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+      EXPECT_EQ(tokens.kind(i), expected.kind(i)) << after;
+      EXPECT_EQ(tokens.offset(i), expected.offset(i)) << after;
+      EXPECT_EQ(tokens.value(i), expected.value(i)) << after;
+    }
+    EXPECT_EQ(changed.first, c.first) << after;
+    EXPECT_EQ(changed.old_end, c.old_end) << after;
+    EXPECT_EQ(changed.new_end, c.new_end) << after;
+  }
+  EXPECT_THROW(relex(lex("a b"), "a \"b", SourceEdit{2, 0, "\""}), LexerError);
+}
+
 TEST(LexerThrowTest, UnterminatedStringLiteral) {
   string input = R"(let s = "This is an unterminated string;)";
   EXPECT_THROW(lex(input), LexerError);
@@ -270,6 +482,21 @@ TEST(LexerThrowTest, UnterminatedComment) {
   EXPECT_THROW(lex(input), LexerError);
 }
 
+TEST(LexerThrowTest, ErrorPosition) {
+  try {
+    lex("let x = 42;\nlet y = `;");
+    FAIL() << "expected LexerError";
+  } catch (const LexerError &e) {
+    EXPECT_EQ(e.position, 20);
+  }
+  try {
+    lex("let x; /* unterminated");
+    FAIL() << "expected LexerError";
+  } catch (const LexerError &e) {
+    EXPECT_EQ(e.position, 7);
+  }
+}
+
 TEST(LexerThrowTest, InvalidEscapeInCharLiteral) {
   string input = R"(let c = '\x12';)";
   EXPECT_THROW(lex(input), LexerError);
@@ -278,4 +505,126 @@ TEST(LexerThrowTest, InvalidEscapeInCharLiteral) {
 TEST(LexerThrowTest, InvalidEscapeInStringLiteral) {
   string input = R"(let s = "This is an invalid escape: \x12";)";
   EXPECT_THROW(lex(input), LexerError);
-}
\ No newline at end of file
+}
+
+TEST(LexerThrowTest, NonAsciiOutsideLiteral) {
+  try {
+    lex("let caf\xc3\xa9 = 1;");
+    FAIL() << "expected LexerError";
+  } catch (const LexerError &e) {
+    EXPECT_EQ(e.position, 7);
+  }
+  auto tokens = lex("\"caf\xc3\xa9\" // \xe2\x82\xac\n");
+  ASSERT_EQ(tokens.size(), 1);
+  EXPECT_EQ(tokens[0].type, Token::Type::StringLiteral);
+}
+
+TEST(LexerThrowTest, InvalidUtf8) {
+  std::vector<std::pair<string, size_t>> inputs = {
+    {"let s = \"\xff\";", 9},
+    {"// caf\xc3", 6},
+    {"/* \xc0\xaf */", 3},          // overlong
+    {"\"\xed\xa0\x80\"", 1},         // surrogate
+    {string(40, ' ') + "'\xf4\x90\x80\x80'", 41}, // above U+10FFFF
+  };
+  for (const auto &[input, position] : inputs) {
+    try {
+      lex(input);
+      ADD_FAILURE() << "expected LexerError";
+    } catch (const LexerError &e) {
+      EXPECT_EQ(e.position, position);
+    }
+  }
+}
+
+TEST(LexerThrowTest, InvalidIntegerLiteral) {
+  std::vector<string> inputs = {"256u8",
+                                "129i8",
+                                "0x",
+                                "18446744073709551616",
+                                "1f32",
+                                "9223372036854775809i64",
+                                "18446744073709551615isize",
+                                "18446744073709551616u64",
+                                "170141183460469231731687303715884105729i128",
+                                "340282366920938463463374607431768211456u128"};
+  for (const auto &input : inputs) {
+    try {
+      lex("let x = " + input + ";");
+      FAIL() << "expected LexerError for " << input;
+    } catch (const LexerError &e) {
+      EXPECT_EQ(e.position, 8) << input;
+    }
+  }
+  EXPECT_EQ(lex("128i8").literal(0).integer, 128);
+
+  // a spelling that failed to decode is not kept, so pushing it again fails again
+  string input = "256u8 1";
+  TokenBuffer buffer(input);
+  Token invalid(Token::Type::IntegerLiteral, std::string_view(input).substr(0, 5));
+  EXPECT_THROW(buffer.push_back(invalid), LexerError);
+  EXPECT_EQ(buffer.size(), 0);
+  EXPECT_EQ(buffer.symbols().size(), 0);
+  EXPECT_THROW(buffer.push_back(invalid), LexerError);
+  Token valid(Token::Type::IntegerLiteral, std::string_view(input).substr(6, 1));
+  valid.offset = 6;
+  buffer.push_back(valid);
+  EXPECT_EQ(buffer.symbol(0), 0);
+  EXPECT_EQ(buffer.literal(0).integer, 1);
+  EXPECT_EQ(lex("18446744073709551615").literal(0).integer, UINT64_MAX);
+  EXPECT_EQ(lex("9223372036854775808i64").literal(0).integer, std::uint64_t{1} << 63);
+  EXPECT_EQ(lex("18446744073709551615u64").literal(0).integer, UINT64_MAX);
+
+  auto i128_min = lex("170141183460469231731687303715884105728i128");
+  EXPECT_EQ(i128_min.literal(0).integer_high, std::uint64_t{1} << 63);
+  EXPECT_EQ(i128_min.literal(0).integer, 0);
+  auto u128_max = lex("0xffff_ffff_ffff_ffff_ffff_ffff_ffff_ffffu128");
+  EXPECT_EQ(u128_max.literal(0).integer_high, UINT64_MAX);
+  EXPECT_EQ(u128_max.literal(0).integer, UINT64_MAX);
+  auto u128 = lex("18446744073709551616u128");
+  EXPECT_EQ(u128.literal(0).integer_high, 1);
+  EXPECT_EQ(u128.literal(0).integer, 0);
+}
+
+TEST(LexerParallelTest, MatchesSerial) {
+  string input;
+  for (int i = 0; i < 50; ++i) {
+    input += "fn f() { let s = \"a // b /* c\\\" \"; /* x \" y /* z */ */ let c = '\"'; }\n";
+    input += "// \"line comment\" /* still one\n  x += 1; \"multi\nline\" /* multi\nline */\n";
+  }
+  auto serial = lex(input);
+  for (size_t chunk_size : {1, 7, 64, 1000}) {
+    auto parallel = lex_parallel(input, 4, chunk_size);
+    ASSERT_EQ(parallel.size(), serial.size());
+    for (size_t i = 0; i < serial.size(); ++i) {
+      EXPECT_EQ(parallel.kind(i), serial.kind(i));
+      EXPECT_EQ(parallel.offset(i), serial.offset(i));
+      EXPECT_EQ(parallel.value(i), serial.value(i));
+      EXPECT_EQ(parallel.symbol(i), serial.symbol(i));
+    }
+  }
+}
+
+TEST(LexerParallelTest, SameErrors) {
+  string input;
+  for (int i = 0; i < 40; ++i) {
+    input += "let s = \"` inside a string\"; // ` inside a comment\n";
+  }
+  for (string tail : {string("let y = `;"), string("/* unterminated"), string("\"caf\xc3")}) {
+    size_t expected = 0;
+    try {
+      lex(input + tail);
+      FAIL() << "expected LexerError";
+    } catch (const LexerError &e) {
+      expected = e.position;
+    }
+    for (size_t chunk_size : {1, 13, 256}) {
+      try {
+        lex_parallel(input + tail, 4, chunk_size);
+        ADD_FAILURE() << "expected LexerError";
+      } catch (const LexerError &e) {
+        EXPECT_EQ(e.position, expected);
+      }
+    }
+  }
+}
@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include "parser.hpp"
+#include "parse_tree.hpp"
+
+#include <vector>
+
+using std::string;
+
+namespace {
+
+string chained_assignments(size_t count) {
+  string source = "fn main() { a0";
+  for (size_t i = 1; i < count; ++i) {
+    source += " = a" + std::to_string(i);
+  }
+  return source + " = 1; }";
+}
+
+string else_if_chain(size_t count) {
+  string source = "fn main() { let x: i32 = 0; if (x == 0) { exit(0); }";
+  for (size_t i = 0; i < count; ++i) {
+    source += " else if (x == " + std::to_string(i) + ") { exit(" + std::to_string(i) + "); }";
+  }
+  return source + " else { exit(1); } }";
+}
+
+double items_per_token(const string &source) {
+  size_t token_count = lex(source).size();
+  EarleyParser parser(lex(source));
+  EXPECT_TRUE(parser.accepts());
+  return static_cast<double>(parser.item_count()) / token_count;
+}
+
+// indexes of the tokens spelled value
+std::vector<size_t> token_indexes(const TokenBuffer &tokens, std::string_view value) {
+  std::vector<size_t> indexes;
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    if (tokens.value(i) == value) {
+      indexes.push_back(i);
+    }
+  }
+  return indexes;
+}
+
+bool accepts(const string &source) {
+  return EarleyParser(lex(source)).accepts();
+}
+
+} // namespace
+
+TEST(ParserTest, RightRecursionItemsGrowLinearly) {
+  for (auto source : {chained_assignments, else_if_chain}) {
+    // the items of a chain are quadratic in its length unless deterministic reductions skip them
+    double small = items_per_token(source(500));
+    double large = items_per_token(source(4000));
+    EXPECT_NEAR(large, small, small * 0.05);
+  }
+}
+
+TEST(ParserTest, ChainedAssignmentsCompleteAtTheSemicolon) {
+  const size_t count = 200;
+  string source = chained_assignments(count);
+  TokenBuffer tokens = lex(source);
+  size_t end = token_indexes(tokens, ";").front();
+  EarleyParser parser(lex(source));
+  ASSERT_TRUE(parser.accepts());
+  CompletedItems completed = parser.completed_items();
+  // every assignment of the chain is right-nested and ends with the 1 before the semicolon
+  for (size_t i = 0; i < count; ++i) {
+    size_t origin = 5 + 2 * i;
+    ASSERT_EQ(tokens.value(origin), "a" + std::to_string(i));
+    for (Nonterminal nonterminal : {Nonterminal::ASSIGNMENT_EXPRESSION, Nonterminal::SIMPLE_ASSIGNMENT_EXPRESSION}) {
+      CompletedItems::Found found = completed.latest(nonterminal, origin, tokens.size());
+      ASSERT_TRUE(found.has_value()) << i;
+      EXPECT_EQ(found->second, end) << i;
+      EXPECT_EQ(found->first.nonterminal_type(), static_cast<int>(nonterminal)) << i;
+      EXPECT_EQ(found->first.start_token_index, origin) << i;
+      EXPECT_TRUE(completed.in_chart(nonterminal, origin, end).has_value()) << i;
+    }
+  }
+}
+
+TEST(ParserTest, ElseIfChainCompletesAtTheLastBlock) {
+  string source = else_if_chain(100);
+  TokenBuffer tokens = lex(source);
+  size_t end = tokens.size() - 1; // the closing brace of main
+  EarleyParser parser(lex(source));
+  ASSERT_TRUE(parser.accepts());
+  CompletedItems completed = parser.completed_items();
+  std::vector<size_t> ifs = token_indexes(tokens, "if");
+  ASSERT_EQ(ifs.size(), 101u);
+  for (size_t origin : ifs) {
+    CompletedItems::Found found = completed.latest(Nonterminal::IF_EXPRESSION, origin, tokens.size());
+    ASSERT_TRUE(found.has_value()) << origin;
+    EXPECT_EQ(found->second, end) << origin;
+    EXPECT_EQ(found->first.start_token_index, origin) << origin;
+  }
+}
+
+TEST(ParserTest, AcceptsPrograms) {
+  EXPECT_TRUE(accepts("fn main() {}"));
+  EXPECT_TRUE(accepts("fn main() { {} {{}} {{2}} }"));
+  EXPECT_TRUE(accepts("const fn answer() -> i32 { 42 }"));
+  EXPECT_TRUE(accepts("fn add(x: i32, y: i32,) -> i32 { x + y }"));
+  EXPECT_TRUE(accepts("fn main() { ; ; f(); g(1, 2,); let a: [i32; 0] = []; }"));
+  EXPECT_TRUE(accepts("fn main() { let x: i32; let y: i32 = 1; let _: i32 = y; }"));
+  EXPECT_TRUE(accepts("fn main() { if (x) {} if (x) {} else {} if (x) {} else if (y) {} else { z } }"));
+  EXPECT_TRUE(accepts("fn main() { loop { break; } while (x < 10) { continue; } return; }"));
+  EXPECT_TRUE(accepts("struct Unit; struct Point { x: i32, y: i32, } enum Nothing {}"));
+  EXPECT_TRUE(accepts("trait Shape { fn area(&self) -> i32; } impl Shape for Point {} impl Point { fn new() {} }"));
+}
+
+TEST(ParserTest, RejectsPrograms) {
+  EXPECT_FALSE(accepts("fn main() { let x: i32 = 1 }"));
+  EXPECT_FALSE(accepts("fn main() {"));
+  EXPECT_FALSE(accepts("fn main() {} }"));
+  EXPECT_FALSE(accepts("fn (x: i32) {}"));
+  EXPECT_FALSE(accepts("fn main() { if x {} }"));
+  EXPECT_FALSE(accepts("fn main() { let x = 1; }")); // let needs a type
+  EXPECT_FALSE(accepts("struct Point { x: i32 y: i32 }"));
+  EXPECT_FALSE(accepts("fn main() { a = ; }"));
+}
+
+TEST(ParserTest, GrammarTables) {
+  EXPECT_TRUE(is_nullable(Nonterminal::ITEMS));
+  EXPECT_TRUE(is_nullable(Nonterminal::OPTIONAL_CONST));
+  EXPECT_TRUE(is_nullable(Nonterminal::OPTIONAL_COMMA));
+  EXPECT_TRUE(is_nullable(Nonterminal::OPTIONAL_FUNCTION_PARAMETERS));
+  EXPECT_TRUE(is_nullable(Nonterminal::STATEMENTS));
+  EXPECT_FALSE(is_nullable(Nonterminal::FUNCTION));
+  EXPECT_FALSE(is_nullable(Nonterminal::BLOCK_EXPRESSION));
+  EXPECT_FALSE(is_nullable(Nonterminal::ASSIGNMENT_EXPRESSION));
+
+  NonterminalSet function = prediction_closure(Nonterminal::FUNCTION);
+  EXPECT_TRUE(function.test(static_cast<size_t>(Nonterminal::FUNCTION)));
+  EXPECT_TRUE(function.test(static_cast<size_t>(Nonterminal::OPTIONAL_CONST)));
+  EXPECT_FALSE(function.test(static_cast<size_t>(Nonterminal::BLOCK_EXPRESSION)));
+  EXPECT_EQ(function.count(), 2u);
+
+  NonterminalSet assignment = prediction_closure(Nonterminal::ASSIGNMENT_EXPRESSION);
+  EXPECT_TRUE(assignment.test(static_cast<size_t>(Nonterminal::SIMPLE_ASSIGNMENT_EXPRESSION)));
+  EXPECT_TRUE(assignment.test(static_cast<size_t>(Nonterminal::LAZY_OR_EXPRESSION)));
+  EXPECT_TRUE(assignment.test(static_cast<size_t>(Nonterminal::BASIC_EXPRESSION)));
+  EXPECT_FALSE(assignment.test(static_cast<size_t>(Nonterminal::FLOW_CONTROL_EXPRESSION)));
+}